@@ -0,0 +1,160 @@
+// Measure compile time and peak memory of generated grammars.
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../corpus.hpp"
+
+namespace {
+
+constexpr const char usage[] = R"(Usage: qcpc_compile_bench [options]
+
+Options:
+  --rules=COUNTS    comma-separated rule counts (default: 50,200,800)
+  --flags=FLAGS     extra compiler flags, space-separated (default: -O0)
+  --keep=DIR        keep generated sources in DIR
+)";
+
+/// Generate a grammar of `count` rules. Every rule is parsed with both `MemoryInput` and
+/// `StringInput` so that per-input instantiation costs show up.
+std::string generate(size_t count, uint64_t seed) {
+    bench::Rng rng(seed);
+    std::string out = "#include \"qcpc/qcpc.hpp\"\n\nusing namespace qcpc;\n\n";
+    auto name = [](size_t i) {
+        std::string ret = "r";
+        ret += std::to_string(i);
+        return ret;
+    };
+    auto pick = [&](size_t i) { return name(rng.below(i)); };
+
+    out += "QCPC_DECL_DEF_(sep) = *one<' ', '\\t', '\\n'>;\n";
+    out += "QCPC_DECL_DEF(r0) = +range<'a', 'z', 'A', 'Z'>;\n";
+    for (size_t i = 1; i < count; ++i) {
+        std::string n = std::to_string(i);
+        out += "QCPC_DECL_DEF(r" + n + ") = ";
+        switch (i % 6) {
+        case 0: out += "QCPC_STR(\"kw" + n + "\") & *" + pick(i) + " & one<';'>"; break;
+        case 1: out += pick(i) + " | " + pick(i) + " | range<'0', '9'>"; break;
+        case 2: out += "list(" + pick(i) + ", one<','>, sep)"; break;
+        case 3: out += "QCPC_KEYWORD(\"word" + n + "\") & -" + pick(i); break;
+        case 4: out += "+(" + pick(i) + " & !" + pick(i) + ") & QCPC_STR(\"end\")"; break;
+        default: out += "join(sep, one<'('>, " + pick(i) + ", one<')'>) | " + pick(i); break;
+        }
+        out += ";\n";
+    }
+
+    out += "\nint main(int argc, char** argv) {\n";
+    out += "    const char* text = argc > 1 ? argv[1] : \"\";\n";
+    out += "    MemoryInput mem(text, text + std::char_traits<char>::length(text));\n";
+    out += "    StringInput str(text);\n";
+    out += "    int count = 0;\n";
+    for (size_t i = 0; i < count; ++i) {
+        out += "    count += bool(parse(" + name(i) + ", mem));\n";
+        out += "    count += bool(parse(" + name(i) + ", str));\n";
+    }
+    out += "    return count;\n}\n";
+    return out;
+}
+
+struct Measurement {
+    bool ok;
+    double seconds;
+    size_t peak_rss_kb;
+};
+
+Measurement compile(const std::string& source, const std::vector<std::string>& flags) {
+    std::vector<std::string> args = {QCPC_CXX_COMPILER,
+                                     "-std=c++20",
+                                     "-c",
+                                     "-o",
+                                     "/dev/null",
+                                     "-I" QCPC_INCLUDE_DIR,
+                                     "-x",
+                                     "c++",
+                                     source};
+    args.insert(args.end() - 3, flags.begin(), flags.end());
+    std::vector<char*> argv;
+    for (auto& arg: args) argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    auto begin = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0) return {false, 0, 0};
+    if (pid == 0) {
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+    int status = 0;
+    rusage usage{};
+    wait4(pid, &status, 0, &usage);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    return {ok, seconds, static_cast<size_t>(usage.ru_maxrss)};
+}
+
+std::vector<std::string> split(std::string_view str, char delim) {
+    std::vector<std::string> ret;
+    while (!str.empty()) {
+        size_t pos = str.find(delim);
+        if (pos != 0) ret.emplace_back(str.substr(0, pos));
+        if (pos == std::string_view::npos) break;
+        str.remove_prefix(pos + 1);
+    }
+    return ret;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> counts = {50, 200, 800};
+    std::vector<std::string> flags = {"-O0"};
+    std::string keep;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("--rules=")) {
+            counts.clear();
+            for (const auto& s: split(arg.substr(8), ',')) counts.push_back(std::stoul(s));
+        } else if (arg.starts_with("--flags=")) {
+            flags = split(arg.substr(8), ' ');
+        } else if (arg.starts_with("--keep=")) {
+            keep = arg.substr(7);
+        } else {
+            std::fputs(usage, arg == "--help" ? stdout : stderr);
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+
+    std::printf("%6s %10s %10s\n", "rules", "seconds", "peakRSS");
+    bool failed = false;
+    for (size_t count: counts) {
+        std::string path = (keep.empty() ? std::string("/tmp") : keep) + "/qcpc_grammar_" +
+                           std::to_string(count) + ".cpp";
+        FILE* file = std::fopen(path.c_str(), "w");
+        if (!file) {
+            std::fprintf(stderr, "cannot write %s\n", path.c_str());
+            return 2;
+        }
+        std::fputs(generate(count, 42).c_str(), file);
+        std::fclose(file);
+
+        auto m = compile(path, flags);
+        if (keep.empty()) std::remove(path.c_str());
+        if (!m.ok) {
+            std::printf("%6zu  FAILED TO COMPILE\n", count);
+            failed = true;
+            continue;
+        }
+        std::printf("%6zu %10.2f %8zuMB\n", count, m.seconds, m.peak_rss_kb / 1024);
+        std::fflush(stdout);
+    }
+    return failed ? 1 : 0;
+}
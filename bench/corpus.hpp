@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace bench {
+
+/// Deterministic pseudo-random generator (SplitMix64). Corpora must be reproducible from the seed
+/// alone, so do not use `std::random_device` or the distributions of `<random>`, whose outputs
+/// are implementation-defined.
+struct Rng {
+    explicit Rng(uint64_t seed) noexcept: _state(seed) {}
+
+    uint64_t next() noexcept {
+        uint64_t z = (this->_state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    /// Return a number in `[0, n)`.
+    uint64_t below(uint64_t n) noexcept {
+        return this->next() % n;
+    }
+
+    /// Return a number in `[lo, hi]`.
+    uint64_t between(uint64_t lo, uint64_t hi) noexcept {
+        return lo + this->below(hi - lo + 1);
+    }
+
+    /// Return `true` with probability `percent / 100`.
+    bool chance(uint64_t percent) noexcept {
+        return this->below(100) < percent;
+    }
+
+  private:
+    uint64_t _state;
+};
+
+/// Append a lowercase identifier of length `[lo, hi]`.
+inline void append_ident(std::string& out, Rng& rng, size_t lo = 1, size_t hi = 10) {
+    size_t len = rng.between(lo, hi);
+    for (size_t i = 0; i < len; ++i) out += static_cast<char>('a' + rng.below(26));
+}
+
+/// Append a decimal number with up to `digits` digits.
+inline void append_number(std::string& out, Rng& rng, size_t digits = 6) {
+    uint64_t limit = 1;
+    for (size_t i = rng.between(1, digits); i > 0; --i) limit *= 10;
+    out += std::to_string(rng.below(limit));
+}
+
+/// Append a sentence of lowercase words separated by single spaces.
+inline void append_words(std::string& out, Rng& rng, size_t lo = 1, size_t hi = 6) {
+    size_t count = rng.between(lo, hi);
+    for (size_t i = 0; i < count; ++i) {
+        if (i != 0) out += ' ';
+        append_ident(out, rng, 1, 8);
+    }
+}
+
+}  // namespace bench
@@ -0,0 +1,103 @@
+#include "../corpus.hpp"
+#include "grammars.hpp"
+#include "qcpc/vm/vm.hpp"
+
+using namespace qcpc;
+
+// Same grammar as `examples/calculator.cpp`, except the top-level rule accepts a list of
+// expressions, one per line.
+
+// clang-format off
+
+QCPC_DECL(calc_expr);
+
+QCPC_DECL_DEF_(calc_sep)
+  = *one<' ', '\t', '\r', '\n'>
+  ;
+QCPC_DECL_DEF(calc_value)
+  = +range<'0', '9'>
+  | join(calc_sep, one<'('>, calc_expr, one<')'>)
+  ;
+QCPC_DECL_DEF(calc_product_op)
+  = one<'*', '/'>
+  ;
+QCPC_DECL_DEF(calc_product)
+  = list(calc_value, calc_product_op, calc_sep)
+  ;
+QCPC_DECL_DEF(calc_sum_op)
+  = one<'+', '-'>
+  ;
+QCPC_DECL_DEF(calc_sum)
+  = list(calc_product, calc_sum_op, calc_sep)
+  ;
+QCPC_DEF(calc_expr)
+  = calc_sum
+  ;
+QCPC_DECL_DEF(calc_lines)
+  = boi & *(calc_sep & calc_expr & one<';'>) & calc_sep & eoi
+  ;
+
+// clang-format on
+
+// The same grammar again, compiled at runtime.
+constexpr const char calc_source[] = R"(
+    lines      <- (sep expr ';')* sep !.
+    sep        <~ [ \t\r\n]*
+    value      <- [0-9]+ / '(' sep expr sep ')'
+    product_op <- [*/]
+    product    <- value (sep product_op sep value)*
+    sum_op     <- [+\-]
+    sum        <- product (sep sum_op sep product)*
+    expr       <- sum
+)";
+
+namespace bench {
+
+namespace {
+
+void append_expr(std::string& out, Rng& rng, size_t depth) {
+    size_t terms = rng.between(1, 6);
+    for (size_t i = 0; i < terms; ++i) {
+        if (i != 0) {
+            if (rng.chance(50)) out += ' ';
+            out += "+-*/"[rng.below(4)];
+            if (rng.chance(50)) out += ' ';
+        }
+        if (depth < 6 && rng.chance(20)) {
+            out += '(';
+            append_expr(out, rng, depth + 1);
+            out += ')';
+        } else {
+            append_number(out, rng, 4);
+        }
+    }
+}
+
+std::string generate(size_t size, uint64_t seed) {
+    Rng rng(seed);
+    std::string out;
+    while (out.size() < size) {
+        append_expr(out, rng, 0);
+        out += ";\n";
+    }
+    return out;
+}
+
+ParseStats parse(std::string_view text, std::pmr::memory_resource* resource) {
+    return parse_text(calc_lines, text, resource);
+}
+
+ParseStats parse_vm(std::string_view text, std::pmr::memory_resource* resource) {
+    static const vm::Program prog = *vm::compile(calc_source);
+    MemoryInput in(text.data(), text.data() + text.size());
+    auto ret = vm::parse(prog, in, {.memory_resource = resource});
+    if (!ret) return {false, 0};
+    return {true, count_tokens(*ret)};
+}
+
+}  // namespace
+
+const Grammar calc_grammar{"calc", generate, parse};
+const Grammar calc_vm_grammar{"calc-vm", generate, parse_vm};
+
+}  // namespace bench
@@ -0,0 +1,230 @@
+#include "../corpus.hpp"
+#include "grammars.hpp"
+
+using namespace qcpc;
+
+// A small C-like language: integer functions, statements and expressions.
+
+// clang-format off
+
+QCPC_DECL(c_expr);
+QCPC_DECL(c_stmt);
+
+QCPC_DECL_DEF_(c_line_comment)
+  = QCPC_STR("//") & *range<' ', '~', '\t'>
+  ;
+QCPC_DECL_DEF_(c_block_comment)
+  = QCPC_STR("/*")
+  & *((!(one<'*'> & one<'/'>)) & range<'\x01', '\x7f'>)
+  & QCPC_STR("*/")
+  ;
+QCPC_DECL_DEF_(c_ws)
+  = *(one<' ', '\t', '\r', '\n'> | c_line_comment | c_block_comment)
+  ;
+QCPC_DECL_DEF(c_ident)
+  = ident
+  ;
+QCPC_DECL_DEF(c_number)
+  = +range<'0', '9'>
+  ;
+QCPC_DECL_DEF(c_string)
+  = one<'"'>
+  & *(range<' ', '!', '#', '[', ']', '~'> | (one<'\\'> & one<'"', '\\', 'n', 't'>))
+  & one<'"'>
+  ;
+QCPC_DECL_DEF(c_call)
+  = c_ident & c_ws & one<'('> & c_ws
+  & -list(c_expr, one<','>, c_ws)
+  & c_ws & one<')'>
+  ;
+QCPC_DECL_DEF_(c_primary)
+  = c_number
+  | c_string
+  | c_call
+  | c_ident
+  | join(c_ws, one<'('>, c_expr, one<')'>)
+  ;
+QCPC_DECL_DEF(c_unary)
+  = -one<'-', '!'> & c_primary
+  ;
+QCPC_DECL_DEF(c_mul_op)
+  = one<'*', '/', '%'>
+  ;
+QCPC_DECL_DEF(c_mul)
+  = list(c_unary, c_mul_op, c_ws)
+  ;
+QCPC_DECL_DEF(c_add_op)
+  = one<'+', '-'>
+  ;
+QCPC_DECL_DEF(c_add)
+  = list(c_mul, c_add_op, c_ws)
+  ;
+QCPC_DECL_DEF(c_rel_op)
+  = QCPC_STR("<=") | QCPC_STR(">=") | QCPC_STR("==") | QCPC_STR("!=") | one<'<', '>'>
+  ;
+QCPC_DEF(c_expr)
+  = list(c_add, c_rel_op, c_ws)
+  ;
+QCPC_DECL_DEF(c_assign)
+  = c_ident & c_ws & one<'='> & !one<'='> & c_ws & c_expr
+  ;
+QCPC_DECL_DEF(c_expr_stmt)
+  = (c_assign | c_expr) & c_ws & one<';'>
+  ;
+QCPC_DECL_DEF(c_decl)
+  = QCPC_KEYWORD("int") & c_ws & c_ident & c_ws
+  & -(one<'='> & c_ws & c_expr & c_ws)
+  & one<';'>
+  ;
+QCPC_DECL_DEF(c_return)
+  = QCPC_KEYWORD("return") & c_ws & -(c_expr & c_ws) & one<';'>
+  ;
+QCPC_DECL_DEF(c_if)
+  = QCPC_KEYWORD("if") & c_ws & one<'('> & c_ws & c_expr & c_ws & one<')'> & c_ws & c_stmt
+  & -(c_ws & QCPC_KEYWORD("else") & c_ws & c_stmt)
+  ;
+QCPC_DECL_DEF(c_while)
+  = QCPC_KEYWORD("while") & c_ws & one<'('> & c_ws & c_expr & c_ws & one<')'> & c_ws & c_stmt
+  ;
+QCPC_DECL_DEF(c_block)
+  = one<'{'> & c_ws & *(c_stmt & c_ws) & one<'}'>
+  ;
+QCPC_DEF(c_stmt)
+  = c_block
+  | c_if
+  | c_while
+  | c_return
+  | c_decl
+  | c_expr_stmt
+  ;
+QCPC_DECL_DEF(c_param)
+  = QCPC_KEYWORD("int") & c_ws & c_ident
+  ;
+QCPC_DECL_DEF(c_function)
+  = QCPC_KEYWORD("int") & c_ws & c_ident & c_ws & one<'('> & c_ws
+  & -list(c_param, one<','>, c_ws)
+  & c_ws & one<')'> & c_ws & c_block
+  ;
+QCPC_DECL_DEF(c_program)
+  = boi & c_ws & *(c_function & c_ws) & eoi
+  ;
+
+// clang-format on
+
+namespace bench {
+
+namespace {
+
+void append_name(std::string& out, Rng& rng) {
+    // Prefix to avoid keywords.
+    out += "v_";
+    append_ident(out, rng, 1, 8);
+}
+
+void append_expr(std::string& out, Rng& rng, size_t depth) {
+    constexpr const char* ops[] = {" + ", " - ", " * ", " / ", " % ", " < ", " == ", " >= "};
+    size_t terms = rng.between(1, 4);
+    for (size_t i = 0; i < terms; ++i) {
+        if (i != 0) out += ops[rng.below(8)];
+        switch (depth < 3 ? rng.below(6) : rng.below(3)) {
+        case 0: append_number(out, rng); break;
+        case 1:
+        case 2: append_name(out, rng); break;
+        case 3: out += "\"str\\n\""; break;
+        case 4:
+            append_name(out, rng);
+            out += '(';
+            append_expr(out, rng, depth + 1);
+            out += ", ";
+            append_expr(out, rng, depth + 1);
+            out += ')';
+            break;
+        default:
+            out += "-(";
+            append_expr(out, rng, depth + 1);
+            out += ')';
+            break;
+        }
+    }
+}
+
+void append_indent(std::string& out, size_t depth) {
+    out.append(4 * depth, ' ');
+}
+
+void append_stmt(std::string& out, Rng& rng, size_t depth) {
+    append_indent(out, depth);
+    switch (depth < 4 ? rng.below(8) : rng.below(5)) {
+    case 0:
+        out += "int ";
+        append_name(out, rng);
+        out += " = ";
+        append_expr(out, rng, 0);
+        out += ";\n";
+        break;
+    case 1:
+    case 2:
+        append_name(out, rng);
+        out += " = ";
+        append_expr(out, rng, 0);
+        out += ";\n";
+        break;
+    case 3:
+        out += "// ";
+        append_words(out, rng);
+        out += '\n';
+        break;
+    case 4:
+        out += "return ";
+        append_expr(out, rng, 0);
+        out += ";\n";
+        break;
+    case 5:
+    case 6: {
+        out += rng.chance(50) ? "if (" : "while (";
+        append_expr(out, rng, 0);
+        out += ") {\n";
+        size_t count = rng.between(1, 4);
+        for (size_t i = 0; i < count; ++i) append_stmt(out, rng, depth + 1);
+        append_indent(out, depth);
+        out += "}\n";
+        break;
+    }
+    default:
+        out += "/* ";
+        append_words(out, rng);
+        out += " * */\n";
+        break;
+    }
+}
+
+std::string generate(size_t size, uint64_t seed) {
+    Rng rng(seed);
+    std::string out;
+    while (out.size() < size) {
+        out += "int ";
+        append_name(out, rng);
+        out += '(';
+        size_t params = rng.below(4);
+        for (size_t i = 0; i < params; ++i) {
+            if (i != 0) out += ", ";
+            out += "int ";
+            append_name(out, rng);
+        }
+        out += ") {\n";
+        size_t count = rng.between(1, 12);
+        for (size_t i = 0; i < count; ++i) append_stmt(out, rng, 1);
+        out += "}\n\n";
+    }
+    return out;
+}
+
+ParseStats parse(std::string_view text, std::pmr::memory_resource* resource) {
+    return parse_text(c_program, text, resource);
+}
+
+}  // namespace
+
+const Grammar clike_grammar{"clike", generate, parse};
+
+}  // namespace bench
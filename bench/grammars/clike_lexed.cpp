@@ -0,0 +1,145 @@
+#include "../corpus.hpp"
+#include "grammars.hpp"
+#include "qcpc/lex/lex.hpp"
+
+using namespace qcpc;
+
+// The C-like language of `clike.cpp`, tokenized first and then parsed over lexemes, so that
+// whitespace and comments are never scanned by the grammar.
+
+namespace {
+
+enum class CTok : char { Ident = 1, Number, String, Int, Return, If, Else, While, Le, Ge, Eq, Ne };
+
+// clang-format off
+constexpr auto c_lexer = lex::lexer(
+    one<' ', '\t', '\r', '\n'>,
+    lex::skip(QCPC_STR("//") & until_any(one<'\n'>)),
+    lex::skip(QCPC_STR("/*") & until<"*/">),
+    lex::define<CTok::Int>(QCPC_KEYWORD("int")),
+    lex::define<CTok::Return>(QCPC_KEYWORD("return")),
+    lex::define<CTok::If>(QCPC_KEYWORD("if")),
+    lex::define<CTok::Else>(QCPC_KEYWORD("else")),
+    lex::define<CTok::While>(QCPC_KEYWORD("while")),
+    lex::define<CTok::Ident>(ident),
+    lex::define<CTok::Number>(decimal),
+    lex::define<CTok::String>(quoted<'"', '"', '\\'>),
+    lex::define<CTok::Le>(QCPC_STR("<=")),
+    lex::define<CTok::Ge>(QCPC_STR(">=")),
+    lex::define<CTok::Eq>(QCPC_STR("==")),
+    lex::define<CTok::Ne>(QCPC_STR("!=")),
+    lex::define<'('>(one<'('>),
+    lex::define<')'>(one<')'>),
+    lex::define<'{'>(one<'{'>),
+    lex::define<'}'>(one<'}'>),
+    lex::define<','>(one<','>),
+    lex::define<';'>(one<';'>),
+    lex::define<'='>(one<'='>),
+    lex::define<'<'>(one<'<'>),
+    lex::define<'>'>(one<'>'>),
+    lex::define<'+'>(one<'+'>),
+    lex::define<'-'>(one<'-'>),
+    lex::define<'*'>(one<'*'>),
+    lex::define<'/'>(one<'/'>),
+    lex::define<'%'>(one<'%'>),
+    lex::define<'!'>(one<'!'>));
+// clang-format on
+
+}  // namespace
+
+// clang-format off
+
+QCPC_DECL(cl_expr);
+QCPC_DECL(cl_stmt);
+
+QCPC_DECL_DEF(cl_ident)
+  = lex::kind<CTok::Ident>
+  ;
+QCPC_DECL_DEF(cl_call)
+  = cl_ident & one<'('> & -list(cl_expr, one<','>) & one<')'>
+  ;
+QCPC_DECL_DEF_(cl_primary)
+  = lex::kind<CTok::Number>
+  | lex::kind<CTok::String>
+  | cl_call
+  | cl_ident
+  | (one<'('> & cl_expr & one<')'>)
+  ;
+QCPC_DECL_DEF(cl_unary)
+  = -one<'-', '!'> & cl_primary
+  ;
+QCPC_DECL_DEF(cl_mul)
+  = list(cl_unary, one<'*', '/', '%'>)
+  ;
+QCPC_DECL_DEF(cl_add)
+  = list(cl_mul, one<'+', '-'>)
+  ;
+QCPC_DEF(cl_expr)
+  = list(cl_add, lex::kind<CTok::Le> | lex::kind<CTok::Ge> | lex::kind<CTok::Eq>
+               | lex::kind<CTok::Ne> | one<'<', '>'>)
+  ;
+QCPC_DECL_DEF(cl_assign)
+  = cl_ident & one<'='> & cl_expr
+  ;
+QCPC_DECL_DEF(cl_expr_stmt)
+  = (cl_assign | cl_expr) & one<';'>
+  ;
+QCPC_DECL_DEF(cl_decl)
+  = lex::kind<CTok::Int> & cl_ident & -(one<'='> & cl_expr) & one<';'>
+  ;
+QCPC_DECL_DEF(cl_return)
+  = lex::kind<CTok::Return> & -cl_expr & one<';'>
+  ;
+QCPC_DECL_DEF(cl_if)
+  = lex::kind<CTok::If> & one<'('> & cl_expr & one<')'> & cl_stmt
+  & -(lex::kind<CTok::Else> & cl_stmt)
+  ;
+QCPC_DECL_DEF(cl_while)
+  = lex::kind<CTok::While> & one<'('> & cl_expr & one<')'> & cl_stmt
+  ;
+QCPC_DECL_DEF(cl_block)
+  = one<'{'> & *cl_stmt & one<'}'>
+  ;
+QCPC_DEF(cl_stmt)
+  = cl_block
+  | cl_if
+  | cl_while
+  | cl_return
+  | cl_decl
+  | cl_expr_stmt
+  ;
+QCPC_DECL_DEF(cl_param)
+  = lex::kind<CTok::Int> & cl_ident
+  ;
+QCPC_DECL_DEF(cl_function)
+  = lex::kind<CTok::Int> & cl_ident & one<'('> & -list(cl_param, one<','>) & one<')'> & cl_block
+  ;
+QCPC_DECL_DEF(cl_program)
+  = *cl_function & eoi
+  ;
+
+// clang-format on
+
+namespace bench {
+
+namespace {
+
+std::string generate(size_t size, uint64_t seed) {
+    return clike_grammar.generate(size, seed);
+}
+
+ParseStats parse(std::string_view text, std::pmr::memory_resource* resource) {
+    lex::TokenStream stream;
+    const char* end = text.data() + text.size();
+    if (c_lexer.tokenize(text.data(), end, stream) != end) return {false, 0};
+    lex::TokenStreamInput in(stream);
+    auto ret = qcpc::parse(cl_program, in, {.memory_resource = resource});
+    if (!ret) return {false, 0};
+    return {true, count_tokens(*ret)};
+}
+
+}  // namespace
+
+const Grammar clike_lexed_grammar{"clike_lexed", generate, parse};
+
+}  // namespace bench
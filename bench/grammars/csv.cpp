@@ -0,0 +1,73 @@
+#include "../corpus.hpp"
+#include "grammars.hpp"
+
+using namespace qcpc;
+
+// clang-format off
+
+QCPC_DECL_DEF(csv_quoted)
+  = one<'"'>
+  & *(range<'\x01', '!', '#', '\x7f'> | QCPC_STR("\"\""))
+  & one<'"'>
+  ;
+QCPC_DECL_DEF(csv_plain)
+  = *range<' ', '!', '#', '+', '-', '~', '\t'>
+  ;
+QCPC_DECL_DEF_(csv_field)
+  = csv_quoted
+  | csv_plain
+  ;
+QCPC_DECL_DEF(csv_record)
+  = list(csv_field, one<','>)
+  ;
+QCPC_DECL_DEF(csv_file)
+  = boi & *(csv_record & eol) & eoi
+  ;
+
+// clang-format on
+
+namespace bench {
+
+namespace {
+
+constexpr size_t COLUMNS = 8;
+
+std::string generate(size_t size, uint64_t seed) {
+    Rng rng(seed);
+    std::string out = "id,name,city,score,ratio,comment,tags,flag\n";
+    while (out.size() < size) {
+        for (size_t col = 0; col < COLUMNS; ++col) {
+            if (col != 0) out += ',';
+            switch (col) {
+            case 0:
+            case 3: append_number(out, rng, 8); break;
+            case 4:
+                append_number(out, rng, 3);
+                out += '.';
+                append_number(out, rng, 4);
+                break;
+            case 5:
+                out += '"';
+                append_words(out, rng, 0, 8);
+                if (rng.chance(20)) out += ", \"\"quoted\"\"";
+                if (rng.chance(5)) out += "\nsecond line";
+                out += '"';
+                break;
+            case 7: out += rng.chance(50) ? "true" : "false"; break;
+            default: append_words(out, rng, 1, 2); break;
+            }
+        }
+        out += '\n';
+    }
+    return out;
+}
+
+ParseStats parse(std::string_view text, std::pmr::memory_resource* resource) {
+    return parse_text(csv_file, text, resource);
+}
+
+}  // namespace
+
+const Grammar csv_grammar{"csv", generate, parse};
+
+}  // namespace bench
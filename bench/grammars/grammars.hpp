@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+#include "../harness.hpp"
+#include "qcpc/qcpc.hpp"
+
+namespace bench {
+
+/// Count `token` and all of its descendants.
+inline size_t count_tokens(const qcpc::Token& token) {
+    size_t count = 1;
+    for (const auto& child: token.children) count += count_tokens(child);
+    return count;
+}
+
+/// Parse `text` as a whole with `rule`, allocating from `resource`, and collect statistics.
+template<class Rule>
+ParseStats parse_text(Rule rule, std::string_view text, std::pmr::memory_resource* resource) {
+    qcpc::MemoryInput in(text.data(), text.data() + text.size());
+    auto ret = qcpc::parse(rule, in, {.memory_resource = resource});
+    if (!ret) return {false, 0};
+    return {true, count_tokens(*ret)};
+}
+
+extern const Grammar json_grammar;
+extern const Grammar json_skewed_grammar;
+extern const Grammar json_skewed_pgo_grammar;
+extern const Grammar csv_grammar;
+extern const Grammar ini_grammar;
+extern const Grammar calc_grammar;
+extern const Grammar calc_vm_grammar;
+extern const Grammar clike_grammar;
+extern const Grammar clike_lexed_grammar;
+
+}  // namespace bench
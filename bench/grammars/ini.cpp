@@ -0,0 +1,78 @@
+#include "../corpus.hpp"
+#include "grammars.hpp"
+
+using namespace qcpc;
+
+// clang-format off
+
+QCPC_DECL_DEF_(ini_ws)
+  = *one<' ', '\t'>
+  ;
+QCPC_DECL_DEF(ini_name)
+  = +range<'a', 'z', 'A', 'Z', '0', '9', '_'>
+  ;
+QCPC_DECL_DEF(ini_section)
+  = one<'['> & ini_ws & list(ini_name, one<'.'>) & ini_ws & one<']'>
+  ;
+QCPC_DECL_DEF(ini_value)
+  = *range<' ', '~', '\t'>
+  ;
+QCPC_DECL_DEF(ini_pair)
+  = ini_name & ini_ws & one<'='> & ini_ws & ini_value
+  ;
+QCPC_DECL_DEF(ini_comment)
+  = one<';', '#'> & *range<' ', '~', '\t'>
+  ;
+QCPC_DECL_DEF_(ini_line)
+  = ini_ws & -(ini_section | ini_pair | ini_comment)
+  ;
+QCPC_DECL_DEF(ini_file)
+  = boi & *(ini_line & eol) & ini_line & eoi
+  ;
+
+// clang-format on
+
+namespace bench {
+
+namespace {
+
+std::string generate(size_t size, uint64_t seed) {
+    Rng rng(seed);
+    std::string out;
+    while (out.size() < size) {
+        out += '[';
+        append_ident(out, rng);
+        if (rng.chance(30)) {
+            out += '.';
+            append_ident(out, rng);
+        }
+        out += "]\n";
+        size_t count = rng.between(1, 16);
+        for (size_t i = 0; i < count; ++i) {
+            switch (rng.below(8)) {
+            case 0: out += "; "; break;
+            case 1: out += "\n"; continue;
+            default: break;
+            }
+            append_ident(out, rng);
+            out += rng.chance(50) ? " = " : "=";
+            if (rng.chance(50))
+                append_number(out, rng);
+            else
+                append_words(out, rng);
+            out += '\n';
+        }
+        out += '\n';
+    }
+    return out;
+}
+
+ParseStats parse(std::string_view text, std::pmr::memory_resource* resource) {
+    return parse_text(ini_file, text, resource);
+}
+
+}  // namespace
+
+const Grammar ini_grammar{"ini", generate, parse};
+
+}  // namespace bench
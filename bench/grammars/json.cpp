@@ -0,0 +1,155 @@
+#include "../corpus.hpp"
+#include "grammars.hpp"
+
+using namespace qcpc;
+
+// clang-format off
+
+QCPC_DECL(json_value);
+
+QCPC_DECL_DEF_(json_ws)
+  = *one<' ', '\t', '\r', '\n'>
+  ;
+QCPC_DECL_DEF_(json_hex)
+  = range<'0', '9', 'a', 'f', 'A', 'F'>
+  ;
+QCPC_DECL_DEF_(json_escape)
+  = one<'\\'>
+  & ( one<'"', '\\', '/', 'b', 'f', 'n', 'r', 't'>
+    | (one<'u'> & json_hex & json_hex & json_hex & json_hex)
+    )
+  ;
+QCPC_DECL_DEF(json_string)
+  = one<'"'>
+  & *(range<' ', '!', '#', '[', ']', '~'> | json_escape)
+  & one<'"'>
+  ;
+QCPC_DECL_DEF_(json_digits)
+  = +range<'0', '9'>
+  ;
+QCPC_DECL_DEF(json_number)
+  = -one<'-'>
+  & (one<'0'> | (range<'1', '9'> & *range<'0', '9'>))
+  & -(one<'.'> & json_digits)
+  & -(one<'e', 'E'> & -one<'+', '-'> & json_digits)
+  ;
+QCPC_DECL_DEF(json_true)
+  = QCPC_STR("true")
+  ;
+QCPC_DECL_DEF(json_false)
+  = QCPC_STR("false")
+  ;
+QCPC_DECL_DEF(json_null)
+  = QCPC_STR("null")
+  ;
+QCPC_DECL_DEF(json_array)
+  = one<'['> & json_ws
+  & -list(json_value, one<','>, json_ws)
+  & json_ws & one<']'>
+  ;
+QCPC_DECL_DEF(json_member)
+  = json_string & json_ws & one<':'> & json_ws & json_value
+  ;
+QCPC_DECL_DEF(json_object)
+  = one<'{'> & json_ws
+  & -list(json_member, one<','>, json_ws)
+  & json_ws & one<'}'>
+  ;
+QCPC_DEF(json_value)
+  = json_object
+  | json_array
+  | json_string
+  | json_number
+  | json_true
+  | json_false
+  | json_null
+  ;
+QCPC_DECL_DEF(json_text)
+  = boi & json_ws & json_value & json_ws & eoi
+  ;
+
+// clang-format on
+
+namespace bench {
+
+namespace {
+
+void append_string(std::string& out, Rng& rng) {
+    out += '"';
+    append_words(out, rng, 0, 4);
+    if (rng.chance(10)) out += "\\n";
+    if (rng.chance(5)) out += "\\u00e9";
+    if (rng.chance(5)) out += "\\\"";
+    out += '"';
+}
+
+void append_value(std::string& out, Rng& rng, size_t depth) {
+    size_t kind = rng.below(depth < 3 ? 8 : 6);
+    switch (kind) {
+    case 0: append_string(out, rng); break;
+    case 1:
+        if (rng.chance(20)) out += '-';
+        append_number(out, rng, 9);
+        break;
+    case 2:
+        append_number(out, rng, 4);
+        out += '.';
+        append_number(out, rng, 6);
+        if (rng.chance(30)) out += rng.chance(50) ? "e-7" : "E+12";
+        break;
+    case 3: out += "true"; break;
+    case 4: out += "false"; break;
+    case 5: out += "null"; break;
+    case 6: {
+        out += '[';
+        size_t count = rng.below(6);
+        for (size_t i = 0; i < count; ++i) {
+            if (i != 0) out += ", ";
+            append_value(out, rng, depth + 1);
+        }
+        out += ']';
+        break;
+    }
+    default: {
+        out += "{\n";
+        size_t count = rng.below(6);
+        for (size_t i = 0; i < count; ++i) {
+            if (i != 0) out += ",\n";
+            out += std::string(2 * depth + 2, ' ');
+            out += '"';
+            append_ident(out, rng);
+            out += "\": ";
+            append_value(out, rng, depth + 1);
+        }
+        out += '}';
+        break;
+    }
+    }
+}
+
+std::string generate(size_t size, uint64_t seed) {
+    Rng rng(seed);
+    std::string out = "[\n";
+    while (out.size() < size) {
+        if (out.size() > 2) out += ",\n";
+        out += "{\"id\": ";
+        append_number(out, rng);
+        out += ", \"name\": ";
+        append_string(out, rng);
+        out += ", \"data\": ";
+        append_value(out, rng, 1);
+        out += '}';
+    }
+    out += "\n]\n";
+    return out;
+}
+
+ParseStats parse(std::string_view text, std::pmr::memory_resource* resource) {
+    return parse_text(json_text, text, resource);
+}
+
+}  // namespace
+
+const Grammar json_grammar{"json", generate, parse};
+
+}  // namespace bench
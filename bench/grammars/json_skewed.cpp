@@ -0,0 +1,126 @@
+// The profile must come before any qcpc header.
+#include "json_skewed.profile.hpp"
+
+#include "../corpus.hpp"
+#include "grammars.hpp"
+
+using namespace qcpc;
+
+// The grammar of `json.cpp` once more, reordered by a profile of the skewed corpus below, where
+// most values are numbers and nulls, which are the fourth and the last alternatives of a value.
+// `json-skewed` parses the same corpus with the grammar of `json.cpp` for comparison.
+//
+// Regenerate the profile with a build where `QCPC_PROFILE` is defined, see `Benchmarks.md`.
+
+// clang-format off
+
+QCPC_DECL(pgo_value);
+
+QCPC_DECL_DEF_(pgo_ws)
+  = *one<' ', '\t', '\r', '\n'>
+  ;
+QCPC_DECL_DEF_(pgo_hex)
+  = range<'0', '9', 'a', 'f', 'A', 'F'>
+  ;
+QCPC_DECL_DEF_(pgo_escape)
+  = one<'\\'>
+  & ( one<'"', '\\', '/', 'b', 'f', 'n', 'r', 't'>
+    | (one<'u'> & pgo_hex & pgo_hex & pgo_hex & pgo_hex)
+    )
+  ;
+QCPC_DECL_DEF(pgo_string)
+  = one<'"'>
+  & *(range<' ', '!', '#', '[', ']', '~'> | pgo_escape)
+  & one<'"'>
+  ;
+QCPC_DECL_DEF_(pgo_digits)
+  = +range<'0', '9'>
+  ;
+QCPC_DECL_DEF(pgo_number)
+  = -one<'-'>
+  & (one<'0'> | (range<'1', '9'> & *range<'0', '9'>))
+  & -(one<'.'> & pgo_digits)
+  & -(one<'e', 'E'> & -one<'+', '-'> & pgo_digits)
+  ;
+QCPC_DECL_DEF(pgo_true)
+  = QCPC_STR("true")
+  ;
+QCPC_DECL_DEF(pgo_false)
+  = QCPC_STR("false")
+  ;
+QCPC_DECL_DEF(pgo_null)
+  = QCPC_STR("null")
+  ;
+QCPC_DECL_DEF(pgo_array)
+  = one<'['> & pgo_ws
+  & -list(pgo_value, one<','>, pgo_ws)
+  & pgo_ws & one<']'>
+  ;
+QCPC_DECL_DEF(pgo_member)
+  = pgo_string & pgo_ws & one<':'> & pgo_ws & pgo_value
+  ;
+QCPC_DECL_DEF(pgo_object)
+  = one<'{'> & pgo_ws
+  & -list(pgo_member, one<','>, pgo_ws)
+  & pgo_ws & one<'}'>
+  ;
+QCPC_DEF(pgo_value)
+  = pgo_object
+  | pgo_array
+  | pgo_string
+  | pgo_number
+  | pgo_true
+  | pgo_false
+  | pgo_null
+  ;
+QCPC_DECL_DEF(pgo_text)
+  = boi & pgo_ws & pgo_value & pgo_ws & eoi
+  ;
+
+// clang-format on
+
+namespace bench {
+
+namespace {
+
+// Rows of samples like a time series export: mostly numbers, some nulls for missing samples, and
+// a label now and then.
+std::string generate(size_t size, uint64_t seed) {
+    Rng rng(seed);
+    std::string out = "[\n";
+    while (out.size() < size) {
+        if (out.size() > 2) out += ",\n";
+        out += '[';
+        for (size_t i = 0; i < 16; ++i) {
+            if (i != 0) out += ", ";
+            size_t kind = rng.below(100);
+            if (kind < 70) {
+                append_number(out, rng, 6);
+            } else if (kind < 95) {
+                out += "null";
+            } else {
+                out += '"';
+                append_ident(out, rng);
+                out += '"';
+            }
+        }
+        out += ']';
+    }
+    out += "\n]\n";
+    return out;
+}
+
+ParseStats parse(std::string_view text, std::pmr::memory_resource* resource) {
+    return json_grammar.parse(text, resource);
+}
+
+ParseStats parse_pgo(std::string_view text, std::pmr::memory_resource* resource) {
+    return parse_text(pgo_text, text, resource);
+}
+
+}  // namespace
+
+const Grammar json_skewed_grammar{"json-skewed", generate, parse};
+const Grammar json_skewed_pgo_grammar{"json-skewed-pgo", generate, parse_pgo};
+
+}  // namespace bench
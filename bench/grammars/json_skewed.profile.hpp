@@ -0,0 +1,27 @@
+// Generated by qcpc::profile::save.
+#pragma once
+
+#ifndef QCPC_PROFILE_DATA
+    #define QCPC_PROFILE_DATA
+#endif
+#include "qcpc/qcpc.hpp"
+
+#ifndef QCPC_DETAIL_PROFILE_DATA
+    #error "Include profiles before any qcpc header."
+#endif
+
+namespace qcpc::detail {
+
+template<>
+inline constexpr SorHits sor_profile<0x23ee10e274490a6bull> =
+    {7, {0, 22272, 17906, 249286, 0, 0, 89128}};
+
+template<>
+inline constexpr SorHits sor_profile<0xbc82a79ffe282627ull> =
+    {2, {4484, 244802}};
+
+template<>
+inline constexpr SorHits sor_profile<0xfea5d8e734d23fa2ull> =
+    {2, {98132, 0}};
+
+}  // namespace qcpc::detail
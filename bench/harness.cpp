@@ -0,0 +1,262 @@
+#include "harness.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/resource.h>
+#elif defined(_MSC_VER)
+    #include <malloc.h>
+#endif
+
+namespace {
+
+// Per thread, so that counting does not contend under multi-threaded load.
+thread_local size_t allocations = 0;
+
+}  // namespace
+
+// Count every allocation so that we can report allocations per input byte.
+
+void* operator new(size_t size) {
+    allocations += 1;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+    std::abort();
+}
+
+void* operator new[](size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+// `std::pmr::new_delete_resource`, e.g. the upstream of arenas, always allocates aligned.
+
+void* operator new(size_t size, std::align_val_t align) {
+    allocations += 1;
+    size_t alignment = static_cast<size_t>(align);
+    size = (size + alignment - 1) / alignment * alignment;
+#if defined(_MSC_VER)
+    if (void* ptr = _aligned_malloc(size == 0 ? alignment : size, alignment)) return ptr;
+#else
+    if (void* ptr = std::aligned_alloc(alignment, size == 0 ? alignment : size)) return ptr;
+#endif
+    std::abort();
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+#if defined(_MSC_VER)
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t align) noexcept {
+    ::operator delete(ptr, align);
+}
+
+namespace bench {
+
+size_t allocation_count() noexcept {
+    return allocations;
+}
+
+size_t peak_rss_kb() noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    #if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;  // bytes on macOS
+    #else
+    return usage.ru_maxrss;
+    #endif
+#else
+    return 0;
+#endif
+}
+
+void reset_peak_rss() noexcept {
+#if defined(__linux__)
+    // Writing "5" to clear_refs resets the peak RSS (Linux >= 4.0).
+    if (FILE* file = std::fopen("/proc/self/clear_refs", "w")) {
+        std::fputs("5", file);
+        std::fclose(file);
+    }
+#endif
+}
+
+bool run(const Grammar& grammar, size_t size, const Options& opts, Result& result) {
+    using Clock = std::chrono::steady_clock;
+
+    std::string text = grammar.generate(size, opts.seed);
+    reset_peak_rss();
+
+    // Warm up and verify.
+    ParseStats stats = grammar.parse(text, nullptr);
+    if (!stats.ok) return false;
+
+    std::atomic<size_t> iters = 0;
+    std::atomic<size_t> allocs = 0;
+    auto time_begin = Clock::now();
+    auto work = [&] {
+        // Like request handling: every parse gets a fresh arena over a buffer kept by the thread,
+        // and everything it allocated is freed at once by `release`.
+        std::vector<std::byte> buffer(1 << 20);
+        std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+        size_t count = 0;
+        size_t allocs_begin = allocation_count();
+        do {
+            grammar.parse(text, opts.arena ? &arena : nullptr);
+            arena.release();
+            count += 1;
+        } while (Clock::now() - time_begin < std::chrono::duration<double>(opts.min_time));
+        iters += count;
+        allocs += allocation_count() - allocs_begin;
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < opts.threads; ++i) workers.emplace_back(work);
+    work();
+    for (auto& worker: workers) worker.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - time_begin).count();
+
+    double bytes = static_cast<double>(text.size()) * static_cast<double>(iters);
+    result.name = grammar.name;
+    if (opts.threads > 1) {
+        result.name += '*';
+        result.name += std::to_string(opts.threads);
+    }
+    if (opts.arena) result.name += "+arena";
+    result.size = size;
+    result.mb_per_sec = bytes / elapsed / 1e6;
+    result.tokens_per_sec = static_cast<double>(stats.tokens) * iters / elapsed;
+    result.allocs_per_byte = static_cast<double>(allocs) / bytes;
+    result.peak_rss_kb = peak_rss_kb();
+    return true;
+}
+
+bool save_baseline(const char* path, const std::vector<Result>& results) {
+    FILE* file = std::fopen(path, "w");
+    if (!file) return false;
+    std::fputs("# name size mb_per_sec tokens_per_sec allocs_per_byte peak_rss_kb\n", file);
+    for (const auto& r: results) {
+        std::fprintf(file,
+                     "%s %zu %.6g %.6g %.6g %zu\n",
+                     r.name.c_str(),
+                     r.size,
+                     r.mb_per_sec,
+                     r.tokens_per_sec,
+                     r.allocs_per_byte,
+                     r.peak_rss_kb);
+    }
+    std::fclose(file);
+    return true;
+}
+
+bool load_baseline(const char* path, std::vector<Result>& results) {
+    FILE* file = std::fopen(path, "r");
+    if (!file) return false;
+    char line[512];
+    while (std::fgets(line, sizeof(line), file)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        char name[256];
+        Result r{};
+        if (std::sscanf(line,
+                        "%255s %zu %lg %lg %lg %zu",
+                        name,
+                        &r.size,
+                        &r.mb_per_sec,
+                        &r.tokens_per_sec,
+                        &r.allocs_per_byte,
+                        &r.peak_rss_kb) != 6) {
+            std::fclose(file);
+            return false;
+        }
+        r.name = name;
+        results.push_back(std::move(r));
+    }
+    std::fclose(file);
+    return true;
+}
+
+size_t compare(const std::vector<Result>& results,
+               const std::vector<Result>& baseline,
+               double threshold) {
+    auto percent = [](double now, double old) { return old == 0 ? 0 : (now - old) / old * 100; };
+
+    size_t regressions = 0;
+    std::printf("\n%-17s %6s %12s %12s  %s\n", "grammar", "size", "MB/s", "allocs/B", "verdict");
+    for (const auto& r: results) {
+        const Result* old = nullptr;
+        for (const auto& b: baseline) {
+            if (b.name == r.name && b.size == r.size) old = &b;
+        }
+        if (!old) {
+            std::printf("%-17s %6s %12s %12s  new\n",
+                        r.name.c_str(),
+                        format_size(r.size).c_str(),
+                        "-",
+                        "-");
+            continue;
+        }
+        double speed = percent(r.mb_per_sec, old->mb_per_sec);
+        double allocs = percent(r.allocs_per_byte, old->allocs_per_byte);
+        bool regressed = speed < -threshold || allocs > threshold;
+        regressions += regressed;
+        std::printf("%-17s %6s %+11.1f%% %+11.1f%%  %s\n",
+                    r.name.c_str(),
+                    format_size(r.size).c_str(),
+                    speed,
+                    allocs,
+                    regressed ? "REGRESSED" : "ok");
+    }
+    return regressions;
+}
+
+std::string format_size(size_t size) {
+    constexpr const char* suffixes[] = {"", "K", "M", "G"};
+    size_t i = 0;
+    while (i < 3 && size >= 1024 && size % 1024 == 0) {
+        size /= 1024;
+        i += 1;
+    }
+    return std::to_string(size) + suffixes[i];
+}
+
+size_t parse_size(std::string_view str) {
+    size_t value = 0;
+    size_t i = 0;
+    for (; i < str.size() && '0' <= str[i] && str[i] <= '9'; ++i) value = value * 10 + (str[i] - '0');
+    if (i == 0) return 0;
+    if (i == str.size()) return value;
+    if (i + 1 != str.size()) return 0;
+    switch (str[i]) {
+    case 'k':
+    case 'K': return value << 10;
+    case 'm':
+    case 'M': return value << 20;
+    case 'g':
+    case 'G': return value << 30;
+    default: return 0;
+    }
+}
+
+}  // namespace bench
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+/// What a grammar driver reports for one parse.
+struct ParseStats {
+    bool ok;
+    size_t tokens;
+};
+
+/// A benchmarked grammar: a deterministic corpus generator plus a parse driver, which allocates
+/// tokens from the given resource, or the default resource if null.
+struct Grammar {
+    const char* name;
+    std::string (*generate)(size_t size, uint64_t seed);
+    ParseStats (*parse)(std::string_view text, std::pmr::memory_resource* resource);
+};
+
+/// Measurement of one (grammar, corpus size) pair.
+struct Result {
+    std::string name;
+    size_t size;
+    double mb_per_sec;
+    double tokens_per_sec;
+    double allocs_per_byte;
+    size_t peak_rss_kb;
+};
+
+struct Options {
+    double min_time = 0.5;  // seconds spent in the timing loop of each case
+    uint64_t seed = 42;
+    size_t threads = 1;  // threads parsing the corpus concurrently
+    bool arena = false;  // give each parse a monotonic arena released after it
+};
+
+/// Return number of calls to global `operator new` by this thread so far.
+[[nodiscard]] size_t allocation_count() noexcept;
+
+/// Return the peak resident set size of this process in KiB.
+[[nodiscard]] size_t peak_rss_kb() noexcept;
+
+/// Try to reset the peak resident set size. It is a no-op on unsupported platforms.
+void reset_peak_rss() noexcept;
+
+/// Generate the corpus and measure `grammar` on it. Return `false` if the corpus fails to parse.
+/// Results of multiple threads or arenas are named like `json*4+arena`.
+bool run(const Grammar& grammar, size_t size, const Options& opts, Result& result);
+
+/// Write results as a baseline file.
+bool save_baseline(const char* path, const std::vector<Result>& results);
+
+/// Read a baseline file written by `save_baseline`.
+bool load_baseline(const char* path, std::vector<Result>& results);
+
+/// Print the difference between `results` and `baseline`. Return the number of cases whose
+/// throughput dropped or allocation rate rose by more than `threshold` percent.
+size_t compare(const std::vector<Result>& results,
+               const std::vector<Result>& baseline,
+               double threshold);
+
+/// Format a byte size like `64K`.
+[[nodiscard]] std::string format_size(size_t size);
+
+/// Parse a byte size like `64K`, `1M` or `1G`. Return 0 on error.
+[[nodiscard]] size_t parse_size(std::string_view str);
+
+}  // namespace bench
@@ -0,0 +1,163 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <vector>
+
+#include "grammars/grammars.hpp"
+#include "harness.hpp"
+
+namespace {
+
+constexpr const char usage[] = R"(Usage: qcpc_bench [options]
+
+Options:
+  --filter=NAMES    comma-separated grammars to run (default: all)
+  --sizes=SIZES     comma-separated corpus sizes, e.g. 1K,64K,1M,1G (default: 1K,64K,1M)
+  --min-time=SEC    minimum measuring time of each case (default: 0.5)
+  --seed=N          corpus generator seed (default: 42)
+  --threads=N       parse the corpus on N threads concurrently (default: 1)
+  --arena           allocate each parse from a monotonic arena released after it
+  --save=FILE       save results as a baseline
+  --profile=FILE    write the profile of choices as a header (QCPC_PROFILE builds only)
+  --compare=FILE    compare results against a baseline, exit with 1 on regression
+  --threshold=PCT   regression threshold in percent (default: 5)
+)";
+
+const bench::Grammar* const grammars[] = {
+    &bench::json_grammar,
+    &bench::json_skewed_grammar,
+    &bench::json_skewed_pgo_grammar,
+    &bench::csv_grammar,
+    &bench::ini_grammar,
+    &bench::calc_grammar,
+    &bench::calc_vm_grammar,
+    &bench::clike_grammar,
+    &bench::clike_lexed_grammar,
+};
+
+std::vector<std::string_view> split(std::string_view str) {
+    std::vector<std::string_view> ret;
+    while (!str.empty()) {
+        size_t comma = str.find(',');
+        ret.push_back(str.substr(0, comma));
+        if (comma == std::string_view::npos) break;
+        str.remove_prefix(comma + 1);
+    }
+    return ret;
+}
+
+bool starts_with(std::string_view str, std::string_view prefix, std::string_view& rest) {
+    if (!str.starts_with(prefix)) return false;
+    rest = str.substr(prefix.size());
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bench::Options opts;
+    std::vector<std::string_view> filter;
+    std::vector<size_t> sizes = {1 << 10, 64 << 10, 1 << 20};
+    const char* save_path = nullptr;
+    [[maybe_unused]] const char* profile_path = nullptr;
+    const char* compare_path = nullptr;
+    double threshold = 5;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i], value;
+        if (starts_with(arg, "--filter=", value)) {
+            filter = split(value);
+        } else if (starts_with(arg, "--sizes=", value)) {
+            sizes.clear();
+            for (auto s: split(value)) {
+                size_t size = bench::parse_size(s);
+                if (size == 0) {
+                    std::fprintf(stderr, "invalid size: %.*s\n", int(s.size()), s.data());
+                    return 2;
+                }
+                sizes.push_back(size);
+            }
+        } else if (starts_with(arg, "--min-time=", value)) {
+            opts.min_time = std::atof(value.data());
+        } else if (starts_with(arg, "--seed=", value)) {
+            opts.seed = std::strtoull(value.data(), nullptr, 10);
+        } else if (starts_with(arg, "--threads=", value)) {
+            opts.threads = std::strtoull(value.data(), nullptr, 10);
+            if (opts.threads == 0) {
+                std::fprintf(stderr, "invalid threads: %.*s\n", int(value.size()), value.data());
+                return 2;
+            }
+        } else if (arg == "--arena") {
+            opts.arena = true;
+#ifdef QCPC_PROFILE
+        } else if (starts_with(arg, "--profile=", value)) {
+            profile_path = value.data();
+#endif
+        } else if (starts_with(arg, "--save=", value)) {
+            save_path = value.data();
+        } else if (starts_with(arg, "--compare=", value)) {
+            compare_path = value.data();
+        } else if (starts_with(arg, "--threshold=", value)) {
+            threshold = std::atof(value.data());
+        } else {
+            std::fputs(usage, arg == "--help" ? stdout : stderr);
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+
+    std::vector<bench::Result> results;
+    bool failed = false;
+    std::printf("%-17s %6s %10s %14s %10s %10s\n",
+                "grammar",
+                "size",
+                "MB/s",
+                "tokens/s",
+                "allocs/B",
+                "peakRSS");
+    for (const auto* grammar: grammars) {
+        if (!filter.empty()) {
+            bool selected = false;
+            for (auto name: filter) selected |= name == grammar->name;
+            if (!selected) continue;
+        }
+        for (size_t size: sizes) {
+            bench::Result r;
+            if (!bench::run(*grammar, size, opts, r)) {
+                std::printf("%-17s %6s  FAILED TO PARSE\n",
+                            grammar->name,
+                            bench::format_size(size).c_str());
+                failed = true;
+                continue;
+            }
+            std::printf("%-17s %6s %10.2f %14.0f %10.4f %8zuMB\n",
+                        r.name.c_str(),
+                        bench::format_size(r.size).c_str(),
+                        r.mb_per_sec,
+                        r.tokens_per_sec,
+                        r.allocs_per_byte,
+                        r.peak_rss_kb / 1024);
+            std::fflush(stdout);
+            results.push_back(std::move(r));
+        }
+    }
+
+#ifdef QCPC_PROFILE
+    if (profile_path && !qcpc::profile::save(profile_path)) {
+        std::fprintf(stderr, "cannot write profile: %s\n", profile_path);
+        return 2;
+    }
+#endif
+    if (save_path && !bench::save_baseline(save_path, results)) {
+        std::fprintf(stderr, "cannot write baseline: %s\n", save_path);
+        return 2;
+    }
+    if (compare_path) {
+        std::vector<bench::Result> baseline;
+        if (!bench::load_baseline(compare_path, baseline)) {
+            std::fprintf(stderr, "cannot read baseline: %s\n", compare_path);
+            return 2;
+        }
+        if (bench::compare(results, baseline, threshold) != 0) return 1;
+    }
+    return failed ? 1 : 0;
+}
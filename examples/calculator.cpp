@@ -1,4 +1,5 @@
 #include <iostream>
+#include <span>
 #include <string_view>
 
 #include "gtest/gtest.h"
@@ -14,7 +15,7 @@ QCPC_DECL_DEF_(sep)
   = *one<' ', '\t', '\r', '\n'>
   ;
 QCPC_DECL_DEF(value)
-  = +range<'0', '9'>
+  = decimal
   | join(sep, one<'('>, expr, one<')'>)
   ;
 QCPC_DECL_DEF(product_op)
@@ -38,19 +39,19 @@ QCPC_DECL_DEF(grammar)
 
 // clang-format on
 
+using CalcRules = RuleIndex<value, product, sum, expr>;
+
 int eval(qcpc::Token& token) {
-    switch (token.tag()) {
-    case value.tag: {
+    switch (CalcRules::of(token)) {
+    case CalcRules::id<value>: {
         std::cout << "value: " << token.view() << '\n';
         if (token.children.empty()) {
-            int ret = 0;
-            for (char c: token) ret = ret * 10 + (c - '0');
-            return ret;
+            return static_cast<int>(*decimal.value(token.view()));
         } else {
             return eval(token.children[0]);
         }
     }
-    case product.tag: {
+    case CalcRules::id<product>: {
         std::cout << "product: " << token.view() << '\n';
         auto iter = token.children.begin();
         int ret = eval(*iter++);
@@ -61,7 +62,7 @@ int eval(qcpc::Token& token) {
         }
         return ret;
     }
-    case sum.tag: {
+    case CalcRules::id<sum>: {
         std::cout << "sum: " << token.view() << '\n';
         auto iter = token.children.begin();
         int ret = eval(*iter++);
@@ -72,7 +73,7 @@ int eval(qcpc::Token& token) {
         }
         return ret;
     }
-    case expr.tag: {
+    case CalcRules::id<expr>: {
         std::cout << "expr: " << token.view() << '\n';
         return eval(token.children[0]);
     }
@@ -83,6 +84,32 @@ int eval(qcpc::Token& token) {
     }
 }
 
+// The same evaluation bottom-up without recursion, so deep trees can not overflow the stack.
+int eval_fold(const qcpc::Token& token) {
+    auto step = [](auto id, const Token& token, std::span<int> values) {
+        if constexpr (id == CalcRules::id<value>) {
+            return values.empty() ? static_cast<int>(*decimal.value(token.view())) : values[0];
+        } else if constexpr (id == CalcRules::id<product> || id == CalcRules::id<sum>) {
+            // Operands alternate with operators, whose values are unused.
+            int ret = values[0];
+            for (size_t i = 1; i < values.size(); i += 2) {
+                switch (*token.children[i].begin()) {
+                case '*': ret *= values[i + 1]; break;
+                case '/': ret /= values[i + 1]; break;
+                case '+': ret += values[i + 1]; break;
+                default: ret -= values[i + 1]; break;
+                }
+            }
+            return ret;
+        } else if constexpr (id == CalcRules::id<expr>) {
+            return values[0];
+        } else {
+            return 0;
+        }
+    };
+    return fold<CalcRules, int>(token, step);
+}
+
 TEST(Calculator, Case1) {
     StringInput in("(1+2)/3*5*6-2");
     auto ret = parse(expr, in);
@@ -96,3 +123,10 @@ TEST(Calculator, Case2) {
     ASSERT_TRUE(ret);
     ASSERT_EQ(eval(ret->children[0]), 28);
 }
+
+TEST(Calculator, Fold) {
+    StringInput in("( 1 + 2 ) / 3 * 5 * 6 - 2");
+    auto ret = parse(expr, in);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(eval_fold(*ret), 28);
+}
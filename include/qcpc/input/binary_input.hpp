@@ -0,0 +1,15 @@
+#pragma once
+
+#include "input_utils.hpp"
+
+namespace qcpc {
+
+/// An input over binary data. Lines and columns are not tracked, so that skipping `n` bytes is
+/// O(1). Tokens report line 1 and column 0, use their offsets from `begin()` instead.
+struct BinaryInput: InputCRTP<BinaryInput> {
+    constexpr static bool tracks_lines = false;
+
+    BinaryInput(const char* begin, const char* end) noexcept: InputCRTP<BinaryInput>(begin, end) {}
+};
+
+}  // namespace qcpc
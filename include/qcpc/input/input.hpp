@@ -1,7 +1,10 @@
 #pragma once
 
+#include "binary_input.hpp"
 #include "input_utils.hpp"
 #include "memory_input.hpp"
+#include "mmap_input.hpp"
+#include "padded_input.hpp"
 #include "string_input.hpp"
-// TODO: mmap_input
+#include "utf8.hpp"
 // TODO: file_input
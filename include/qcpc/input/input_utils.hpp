@@ -2,9 +2,13 @@
 
 #include <concepts>
 #include <cstddef>
+#include <cstring>
 
 namespace qcpc {
 
+/// Bytes readable past the end of padded inputs, all zero. It covers the widest vector load.
+inline constexpr size_t INPUT_PADDING = 64;
+
 struct InputPos {
     const char* current;
     size_t line;
@@ -15,6 +19,24 @@ struct InputPos {
 
 template<class Derived>
 struct InputCRTP {
+    /// The type rules are instantiated with. Inputs which only differ in how they own the buffer
+    /// derive from the same input type and inherit this alias, so that they share instantiations.
+    using ParseAs = Derived;
+
+    /// Whether the input is valid UTF-8 and columns count code points. Bytes by default.
+    constexpr static bool is_utf8 = false;
+
+    /// Whether lines and columns are tracked. Without them, advancing is O(1).
+    constexpr static bool tracks_lines = true;
+
+    /// Whether the input is split into segments, see `SegmentedInput`. Otherwise characters from
+    /// the current position to `end()` are contiguous.
+    constexpr static bool is_segmented = false;
+
+    /// Number of zero bytes readable past `end()`, see `PaddedInput`. Rules read up to that far
+    /// without checking for the end of input.
+    constexpr static size_t padding = 0;
+
     InputCRTP(const char* begin, const char* end) noexcept: _begin(begin), _end(end) {}
 
     InputCRTP(const InputCRTP&) = delete;
@@ -61,6 +83,12 @@ struct InputCRTP {
         return this->_current;
     }
 
+    /// Return a pointer to the next `n` characters in contiguous memory, or nullptr if fewer
+    /// remain.
+    [[nodiscard]] const char* contiguous(size_t n) const noexcept {
+        return this->size() >= n ? this->_current : nullptr;
+    }
+
     /// Return current position.
     [[nodiscard]] InputPos pos() const noexcept {
         return {this->_current, this->_line, this->_column};
@@ -85,7 +113,40 @@ struct InputCRTP {
 
     /// Execute self-increment `n` times.
     void advance(size_t n) noexcept {
-        for (size_t i = 0; i < n; ++i) this->_next();
+        if constexpr (Derived::tracks_lines) {
+            for (size_t i = 0; i < n; ++i) this->_next();
+        } else {
+            this->_current += n;
+        }
+    }
+
+    /// Make `end` the end of input and return the previous one, to parse a part of the remaining
+    /// input on its own.
+    const char* exchange_end(const char* end) noexcept {
+        const char* ret = this->_end;
+        this->_end = end;
+        return ret;
+    }
+
+    /// Move forward to `p`, counting lines with `memchr` rather than character by character.
+    void advance_to(const char* p) noexcept {
+        if constexpr (!Derived::tracks_lines) {
+            this->_current = p;
+            return;
+        }
+        const void* nl;
+        while ((nl = std::memchr(this->_current, '\n', p - this->_current))) {
+            this->_line += 1;
+            this->_column = 0;
+            this->_current = static_cast<const char*>(nl) + 1;
+        }
+        if constexpr (Derived::is_utf8) {
+            for (; this->_current != p; ++this->_current)
+                this->_column += (static_cast<unsigned char>(*this->_current) & 0xc0) != 0x80;
+        } else {
+            this->_column += p - this->_current;
+            this->_current = p;
+        }
     }
 
   protected:
@@ -98,9 +159,17 @@ struct InputCRTP {
     InputCRTP() = default;
 
     void _next() noexcept {
-        if (*this->_current++ == '\n') {
+        if constexpr (!Derived::tracks_lines) {
+            this->_current += 1;
+            return;
+        }
+        char c = *this->_current++;
+        if (c == '\n') {
             this->_line += 1;
             this->_column = 0;
+        } else if constexpr (Derived::is_utf8) {
+            // Continuation bytes belong to the code point before.
+            this->_column += (static_cast<unsigned char>(c) & 0xc0) != 0x80;
         } else {
             this->_column += 1;
         }
@@ -108,6 +177,7 @@ struct InputCRTP {
 };
 
 template<class T>
-concept InputType = std::derived_from<T, InputCRTP<T>>;
+concept InputType =
+    std::derived_from<T, InputCRTP<typename T::ParseAs>> && std::derived_from<T, typename T::ParseAs>;
 
 }  // namespace qcpc
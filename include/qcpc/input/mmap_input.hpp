@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(_WIN32)
+    #include <cstdio>
+    #include <string>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "memory_input.hpp"
+#include "padded_input.hpp"
+
+namespace qcpc {
+
+namespace detail {
+
+/// The padding of files which are not open.
+inline constexpr char EMPTY_FILE[INPUT_PADDING] = {};
+
+/// A read-only file mapping followed by at least `INPUT_PADDING` zero bytes, so that rules may
+/// read past the end of input, see `PaddedInput`.
+class FileMapping {
+  public:
+    explicit FileMapping(const char* path) noexcept {
+#if defined(_WIN32)
+        // Without a portable way to map past the end of a file, read it into memory instead.
+        std::FILE* file = std::fopen(path, "rb");
+        if (!file) return;
+        char buffer[1 << 16];
+        size_t n;
+        while ((n = std::fread(buffer, 1, sizeof(buffer), file)) != 0)
+            this->_buffer.append(buffer, n);
+        this->_is_open = !std::ferror(file);
+        std::fclose(file);
+        this->_size = this->_buffer.size();
+        this->_buffer.append(INPUT_PADDING, '\0');
+        this->_data = this->_buffer.data();
+#else
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return;
+        struct stat info {};
+        if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+            // Reserve zeroed pages covering the file and the padding, then map the file over
+            // them, since touching pages beyond the end of a mapped file is an error.
+            size_t page = ::sysconf(_SC_PAGESIZE);
+            size_t size = static_cast<size_t>(info.st_size);
+            this->_mapped = ((size + INPUT_PADDING) / page + 1) * page;
+            void* base =
+                ::mmap(nullptr, this->_mapped, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (base != MAP_FAILED) {
+                if (size == 0 ||
+                    ::mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) != MAP_FAILED) {
+                    this->_data = static_cast<const char*>(base);
+                    this->_size = size;
+                    this->_is_open = true;
+                } else {
+                    ::munmap(base, this->_mapped);
+                }
+            }
+        }
+        ::close(fd);
+#endif
+    }
+
+    FileMapping(const FileMapping&) = delete;
+    FileMapping& operator=(const FileMapping&) = delete;
+
+    ~FileMapping() {
+#if !defined(_WIN32)
+        if (this->_is_open) ::munmap(const_cast<char*>(this->_data), this->_mapped);
+#endif
+    }
+
+  protected:
+    const char* _data = EMPTY_FILE;
+    size_t _size = 0;
+    bool _is_open = false;
+
+  private:
+#if defined(_WIN32)
+    std::string _buffer;
+#else
+    size_t _mapped = 0;
+#endif
+};
+
+}  // namespace detail
+
+/// A `MemoryInput` over a file mapped into memory. Files that can not be opened or mapped give an
+/// empty input with `is_open()` being false. Rules are instantiated with `MemoryInput` only.
+struct MmapInput
+    : private detail::FileMapping
+    , MemoryInput {
+    // Same as `StringInput`, `FileMapping` is initialized first.
+    explicit MmapInput(const char* path) noexcept
+        : detail::FileMapping(path), MemoryInput(this->_data, this->_data + this->_size) {}
+
+    [[nodiscard]] bool is_open() const noexcept {
+        return this->_is_open;
+    }
+};
+
+/// A `PaddedInput` over a file mapped into memory, which is padded with zero pages. Rules are
+/// instantiated with `PaddedInput` only.
+struct PaddedMmapInput
+    : private detail::FileMapping
+    , PaddedInput {
+    explicit PaddedMmapInput(const char* path) noexcept
+        : detail::FileMapping(path), PaddedInput(this->_data, this->_data + this->_size) {}
+
+    [[nodiscard]] bool is_open() const noexcept {
+        return this->_is_open;
+    }
+};
+
+}  // namespace qcpc
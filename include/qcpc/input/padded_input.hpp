@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <utility>
+
+#include "input_utils.hpp"
+#include "string_input.hpp"
+
+namespace qcpc {
+
+/// An input followed by `INPUT_PADDING` zero bytes, which the caller guarantees. Rules then read
+/// past `end()` instead of checking for the end of input, e.g. `one<'a'>` compares the character
+/// at `end()` which is never 'a', and scan text 16 bytes at a time up to the last byte.
+///
+/// The padding must be zeros: rules only skip checks when they can not match a zero byte, so
+/// `one<'\0'>` still checks for the end of input.
+struct PaddedInput: InputCRTP<PaddedInput> {
+    constexpr static size_t padding = INPUT_PADDING;
+
+    PaddedInput(const char* begin, const char* end) noexcept: InputCRTP<PaddedInput>(begin, end) {}
+};
+
+namespace detail {
+
+/// `Input` without padding, to parse a window of it whose end is followed by more input rather
+/// than zeros, e.g. the body of `binary::length_prefixed`.
+template<class Input>
+struct Unpadded: Input {
+    constexpr static size_t padding = 0;
+
+    using Input::Input;
+};
+
+}  // namespace detail
+
+/// A `PaddedInput` which owns its string, padded on construction. Given a range, the range is
+/// copied. Rules are instantiated with `PaddedInput` only.
+struct PaddedStringInput
+    : private detail::StringHolder
+    , PaddedInput {
+    // Same as `StringInput`, `StringHolder` is initialized first.
+    explicit PaddedStringInput(std::string str)
+        : detail::StringHolder{pad(std::move(str))},
+          PaddedInput(this->_str.data(), this->_str.data() + this->_str.size() - INPUT_PADDING) {}
+
+    PaddedStringInput(const char* begin, const char* end)
+        : PaddedStringInput(std::string(begin, end)) {}
+
+  private:
+    [[nodiscard]] static std::string pad(std::string str) {
+        str.append(INPUT_PADDING, '\0');
+        return str;
+    }
+};
+
+}  // namespace qcpc
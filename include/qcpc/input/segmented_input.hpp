@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../parser/result.hpp"
+#include "../parser/token.hpp"
+#include "input_utils.hpp"
+
+namespace qcpc {
+
+namespace detail {
+
+/// Segments of a `SegmentedInput`, initialized before `InputCRTP` like `StringHolder`.
+struct SegmentList {
+    std::vector<std::string_view> _segments;
+    std::vector<size_t> _after;  // number of characters in segments after each one
+    std::string _copy;
+    mutable std::string _stitch;
+
+    explicit SegmentList(std::vector<std::string_view> segments) {
+        std::erase_if(segments, [](std::string_view s) { return s.empty(); });
+        // Positions are compared by address, so segments out of order are concatenated instead.
+        bool ascending = true;
+        for (size_t i = 1; i < segments.size(); ++i)
+            ascending &= segments[i - 1].data() + segments[i - 1].size() <= segments[i].data();
+        if (!ascending) {
+            for (auto segment: segments) this->_copy += segment;
+            segments = {this->_copy};
+        }
+        if (segments.empty()) segments.push_back({});
+        this->_segments = std::move(segments);
+        this->_after.resize(this->_segments.size());
+        for (size_t i = this->_segments.size() - 1; i > 0; --i)
+            this->_after[i - 1] = this->_after[i] + this->_segments[i].size();
+    }
+};
+
+}  // namespace detail
+
+/// An input over several buffers, e.g. network segments or parts of a file, without copying them
+/// into one. Rules match across segments as if they were concatenated.
+///
+/// Segments must be in ascending address order, since positions are compared by address, which
+/// holds for parts of one buffer or mapping. Otherwise they are concatenated up front.
+///
+/// `end()` is the end of the current segment, the contiguous part of the remaining input, while
+/// `size()` counts all remaining characters. Rules take a fast path within a segment, and copy
+/// a literal crossing segments into a small stitching buffer. Tokens may span segments, in which
+/// case `Token::view()` is invalid and `text(token)` copies their text.
+struct SegmentedInput
+    : private detail::SegmentList
+    , InputCRTP<SegmentedInput> {
+    constexpr static bool is_segmented = true;
+
+    explicit SegmentedInput(std::vector<std::string_view> segments)
+        : detail::SegmentList(std::move(segments)),
+          InputCRTP<SegmentedInput>(this->_segments[0].data(),
+                                    this->_segments[0].data() + this->_segments[0].size()) {}
+
+    SegmentedInput& operator++() noexcept {
+        this->_next();
+        this->_normalize();
+        return *this;
+    }
+
+    [[nodiscard]] char operator[](size_t n) const noexcept {
+        if (n < size_t(this->_end - this->_current)) return this->_current[n];
+        n -= this->_end - this->_current;
+        size_t i = this->_index + 1;
+        for (; n >= this->_segments[i].size(); ++i) n -= this->_segments[i].size();
+        return this->_segments[i][n];
+    }
+
+    /// Return number of remaining characters in all segments.
+    [[nodiscard]] size_t size() const noexcept {
+        return (this->_end - this->_current) + this->_after[this->_index];
+    }
+
+    /// Return a pointer to the next `n` characters, which are copied into the stitching buffer if
+    /// they cross segments. It is valid until the next call.
+    [[nodiscard]] const char* contiguous(size_t n) const {
+        if (size_t(this->_end - this->_current) >= n) return this->_current;
+        if (this->size() < n) return nullptr;
+        this->_stitch.assign(this->_current, this->_end);
+        for (size_t i = this->_index + 1; this->_stitch.size() < n; ++i)
+            this->_stitch.append(this->_segments[i].substr(0, n - this->_stitch.size()));
+        return this->_stitch.data();
+    }
+
+    void jump(InputPos pos) noexcept {
+        InputCRTP<SegmentedInput>::jump(pos);
+        std::string_view segment = this->_segments[this->_index];
+        if (pos.current >= segment.data() && pos.current < segment.data() + segment.size())
+            return;
+        // Find the last segment beginning at or before the position.
+        auto it = std::upper_bound(
+            this->_segments.begin(), this->_segments.end(), pos.current,
+            [](const char* p, std::string_view s) { return p < s.data(); });
+        this->_index = it - this->_segments.begin() - 1;
+        this->_end = this->_segments[this->_index].data() + this->_segments[this->_index].size();
+    }
+
+    void advance(size_t n) noexcept {
+        while (n != 0) {
+            size_t step = std::min(n, size_t(this->_end - this->_current));
+            InputCRTP<SegmentedInput>::advance(step);
+            this->_normalize();
+            n -= step;
+        }
+    }
+
+    /// Move forward to `p`, which is at most `end()`.
+    void advance_to(const char* p) noexcept {
+        InputCRTP<SegmentedInput>::advance_to(p);
+        this->_normalize();
+    }
+
+    /// Windows of `binary::length_prefixed` are not supported.
+    const char* exchange_end(const char* end) = delete;
+
+    /// Return the text from `begin` to `end`, e.g. of a token, copied if it crosses segments.
+    [[nodiscard]] std::string text(const char* begin, const char* end) const {
+        std::string ret;
+        for (size_t i = this->_find(begin); begin != end; begin = this->_segments[++i].data()) {
+            const char* segment_end = this->_segments[i].data() + this->_segments[i].size();
+            if (end >= this->_segments[i].data() && end <= segment_end) {
+                ret.append(begin, end);
+                break;
+            }
+            ret.append(begin, segment_end);
+            if (i + 1 == this->_segments.size()) break;
+        }
+        return ret;
+    }
+
+    [[nodiscard]] std::string text(const Token& token) const {
+        return this->text(token.begin(), token.end());
+    }
+
+    /// Set line and column of `error`, counting across segments.
+    void locate(ParseError& error) const noexcept {
+        error.line = 1;
+        error.column = 0;
+        for (auto segment: this->_segments) {
+            for (const char& c: segment) {
+                if (&c == error.position) return;
+                if (c == '\n') {
+                    error.line += 1;
+                    error.column = 0;
+                } else {
+                    error.column += 1;
+                }
+            }
+        }
+    }
+
+  private:
+    size_t _index = 0;
+
+    /// Keep the position off the end of segments but the last, so that `is_eoi` and `*in` need
+    /// no segment checks.
+    void _normalize() noexcept {
+        if (this->_current != this->_end || this->_index + 1 == this->_segments.size()) return;
+        this->_index += 1;
+        this->_current = this->_segments[this->_index].data();
+        this->_end = this->_current + this->_segments[this->_index].size();
+    }
+
+    [[nodiscard]] size_t _find(const char* p) const noexcept {
+        auto it = std::upper_bound(
+            this->_segments.begin(), this->_segments.end(), p,
+            [](const char* q, std::string_view s) { return q < s.data(); });
+        return it == this->_segments.begin() ? 0 : it - this->_segments.begin() - 1;
+    }
+};
+
+}  // namespace qcpc
@@ -0,0 +1,10 @@
+#pragma once
+
+// SSE2 is part of x86-64, so it is used without runtime detection. Other targets take the
+// portable paths.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define QCPC_HAS_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define QCPC_HAS_SSE2 0
+#endif
@@ -3,23 +3,29 @@
 #include <string>
 #include <utility>
 
-#include "input_utils.hpp"
+#include "memory_input.hpp"
 
 namespace qcpc {
 
-struct StringInput: InputCRTP<StringInput> {
-    explicit StringInput(std::string str) noexcept: InputCRTP<StringInput>(), _str(std::move(str)) {
-        // `str` should be moved to `_str` first, otherwise `_current` and `_end` may point to wrong
-        // position due to SSO.
-        // The self-references (`_current` and `_end` point to the data owned by `_str`) are safe,
-        // because input classes are non-copyable and non-movable.
-        this->_begin = &*this->_str.begin();
-        this->_end = &*this->_str.end();
-        this->_current = this->_begin;
-    }
-
-  protected:
+namespace detail {
+
+struct StringHolder {
     std::string _str;
 };
 
+}  // namespace detail
+
+/// A `MemoryInput` which owns its string. Rules are instantiated with `MemoryInput` only.
+struct StringInput
+    : private detail::StringHolder
+    , MemoryInput {
+    // `StringHolder` is a base class listed before `MemoryInput`, so `str` is moved to `_str`
+    // first, otherwise `_current` and `_end` may point to wrong position due to SSO.
+    // The self-references (`_current` and `_end` point to the data owned by `_str`) are safe,
+    // because input classes are non-copyable and non-movable.
+    explicit StringInput(std::string str) noexcept
+        : detail::StringHolder{std::move(str)}
+        , MemoryInput(this->_str.data(), this->_str.data() + this->_str.size()) {}
+};
+
 }  // namespace qcpc
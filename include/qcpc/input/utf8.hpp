@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "input_utils.hpp"
+#include "simd.hpp"
+
+namespace qcpc {
+
+namespace utf8 {
+
+namespace detail {
+
+/// Decode the code point at `p` into `cp` and return its length, or return 0 if the sequence is
+/// invalid, overlong, a surrogate, out of range or cut by `end`.
+[[nodiscard]] inline size_t decode(const char* p, const char* end, char32_t& cp) noexcept {
+    auto byte = [p](size_t i) {
+        return static_cast<unsigned char>(p[i]);
+    };
+    auto is_cont = [&](size_t i) {
+        return (byte(i) & 0xc0) == 0x80;
+    };
+
+    size_t size = end - p;
+    unsigned char lead = byte(0);
+    if (lead < 0x80) {
+        cp = lead;
+        return 1;
+    }
+    if (lead < 0xc2) return 0;
+    if (lead < 0xe0) {
+        if (size < 2 || !is_cont(1)) return 0;
+        cp = char32_t(lead & 0x1f) << 6 | (byte(1) & 0x3f);
+        return 2;
+    }
+    if (lead < 0xf0) {
+        if (size < 3 || !is_cont(1) || !is_cont(2)) return 0;
+        if (lead == 0xe0 && byte(1) < 0xa0) return 0;   // overlong
+        if (lead == 0xed && byte(1) >= 0xa0) return 0;  // surrogate
+        cp = char32_t(lead & 0x0f) << 12 | char32_t(byte(1) & 0x3f) << 6 | (byte(2) & 0x3f);
+        return 3;
+    }
+    if (lead < 0xf5) {
+        if (size < 4 || !is_cont(1) || !is_cont(2) || !is_cont(3)) return 0;
+        if (lead == 0xf0 && byte(1) < 0x90) return 0;   // overlong
+        if (lead == 0xf4 && byte(1) >= 0x90) return 0;  // above U+10FFFF
+        cp = char32_t(lead & 0x07) << 18 | char32_t(byte(1) & 0x3f) << 12 |
+             char32_t(byte(2) & 0x3f) << 6 | (byte(3) & 0x3f);
+        return 4;
+    }
+    return 0;
+}
+
+/// Like `decode`, but `p` must point to a valid sequence.
+[[nodiscard]] inline size_t decode_valid(const char* p, char32_t& cp) noexcept {
+    auto byte = [p](size_t i) {
+        return char32_t(static_cast<unsigned char>(p[i]));
+    };
+
+    char32_t lead = byte(0);
+    if (lead < 0x80) {
+        cp = lead;
+        return 1;
+    }
+    if (lead < 0xe0) {
+        cp = (lead & 0x1f) << 6 | (byte(1) & 0x3f);
+        return 2;
+    }
+    if (lead < 0xf0) {
+        cp = (lead & 0x0f) << 12 | (byte(1) & 0x3f) << 6 | (byte(2) & 0x3f);
+        return 3;
+    }
+    cp = (lead & 0x07) << 18 | (byte(1) & 0x3f) << 12 | (byte(2) & 0x3f) << 6 | (byte(3) & 0x3f);
+    return 4;
+}
+
+/// Return the end of the leading run of ASCII characters in `[p, end)`.
+[[nodiscard]] inline const char* skip_ascii(const char* p, const char* end) noexcept {
+#if QCPC_HAS_SSE2
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        if (_mm_movemask_epi8(chunk) != 0) break;
+        p += 16;
+    }
+#else
+    while (end - p >= 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, p, 8);
+        if ((chunk & 0x8080808080808080) != 0) break;
+        p += 8;
+    }
+#endif
+    while (p != end && static_cast<unsigned char>(*p) < 0x80) ++p;
+    return p;
+}
+
+}  // namespace detail
+
+/// Return a pointer to the first byte in `[begin, end)` which is not part of a valid UTF-8
+/// sequence, or `end` if there is none. Runs of ASCII, the common case, are checked 16 bytes at
+/// a time with SSE2 or 8 bytes at a time otherwise.
+[[nodiscard]] inline const char* validate(const char* begin, const char* end) noexcept {
+    const char* p = begin;
+    while ((p = detail::skip_ascii(p, end)) != end) {
+        char32_t cp;
+        size_t size = detail::decode(p, end, cp);
+        if (size == 0) return p;
+        p += size;
+    }
+    return end;
+}
+
+}  // namespace utf8
+
+/// An input over valid UTF-8, whose columns count code points instead of bytes. Rules in
+/// `qcpc::utf8` decode it without checking, so validate untrusted data with `utf8::validate`
+/// before. It does not own the data, e.g. view a `MmapInput` with
+/// `Utf8Input in(file.begin(), file.end())`.
+struct Utf8Input: InputCRTP<Utf8Input> {
+    constexpr static bool is_utf8 = true;
+
+    Utf8Input(const char* begin, const char* end) noexcept: InputCRTP<Utf8Input>(begin, end) {}
+};
+
+}  // namespace qcpc
@@ -0,0 +1,4 @@
+#pragma once
+
+#include "lexer.hpp"
+#include "token_stream.hpp"
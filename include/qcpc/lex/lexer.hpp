@@ -0,0 +1,181 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "../parser/parser.hpp"
+#include "token_stream.hpp"
+
+namespace qcpc::lex {
+
+namespace detail {
+
+/// Return the name of the enumerator `K`, e.g. `Ident` for `Tok::Ident`.
+template<auto K>
+consteval auto enum_name() {
+#if defined(__GNUC__) || defined(__clang__)
+    std::string_view name = __PRETTY_FUNCTION__;
+    size_t begin = name.find("K = ") + 4;
+    size_t end = name.find_first_of(";]", begin);
+#elif defined(_MSC_VER)
+    std::string_view name = __FUNCSIG__;
+    size_t begin = name.find("enum_name<") + 10;
+    size_t end = name.rfind(">(");
+#else
+    #error "No support for this compiler."
+#endif
+    name = name.substr(begin, end - begin);
+    if (size_t colons = name.rfind("::"); colons != std::string_view::npos)
+        name = name.substr(colons + 2);
+    ::qcpc::detail::Description<64> ret;
+    for (char c: name.substr(0, 64)) ret.push(c);
+    return ret;
+}
+
+/// Return whether `K` fits in the byte a lexeme kind is stored as, so that no two kinds are the
+/// same byte.
+template<auto K>
+consteval bool is_byte_kind() {
+    using T = decltype(K);
+    using U = typename std::conditional_t<std::is_enum_v<T>,
+                                          std::underlying_type<T>,
+                                          std::type_identity<T>>::type;
+    if constexpr (std::is_same_v<U, char>) {
+        return true;
+    } else {
+        return std::in_range<unsigned char>(static_cast<U>(K));
+    }
+}
+
+/// Mark characters the `i`-th entry of a lexer, matched by `R`, may begin with.
+template<class R>
+constexpr void add_candidate(std::array<uint64_t, 256>& table, size_t i) {
+    for (size_t c = 0; c < 256; ++c) {
+        if (!::qcpc::detail::FirstChars<R>::known || ::qcpc::detail::FirstChars<R>::chars[c])
+            table[c] |= uint64_t(1) << i;
+    }
+}
+
+}  // namespace detail
+
+/// Match and consume a lexeme of kind `K` from a `TokenStreamInput`. Failures report the name of
+/// the enumerator, e.g. "expected Ident".
+template<auto K>
+    requires std::is_enum_v<decltype(K)>
+struct Kind {
+    static_assert(detail::is_byte_kind<K>(), "kinds must be between 0 and 255");
+
+    QCPC_DETAIL_DEFINE_PARSE(Kind) {
+        if (in.is_eoi() || *in != static_cast<char>(K)) return false;
+        ++in;
+        return true;
+    }
+
+    constexpr static auto expected = detail::enum_name<K>();
+};
+
+template<auto K>
+inline constexpr Kind<K> kind{};
+
+/// A lexeme of kind `K` matched by `R`.
+template<auto K, RuleType R>
+struct Define {
+    static_assert(detail::is_byte_kind<K>(), "kinds must be between 0 and 255");
+
+    using Rule = R;
+    constexpr static bool is_skipped = false;
+    constexpr static char kind = static_cast<char>(K);
+};
+
+template<auto K, RuleType R>
+[[nodiscard]] constexpr Define<K, R> define(R) {
+    return {};
+}
+
+/// Input matched by `R` and dropped, e.g. comments.
+template<RuleType R>
+struct Skip {
+    using Rule = R;
+    constexpr static bool is_skipped = true;
+    constexpr static char kind = 0;
+};
+
+template<RuleType R>
+[[nodiscard]] constexpr Skip<R> skip(R) {
+    return {};
+}
+
+template<class Space, class... Es>
+struct Lexer;
+
+/// Split a source text into lexemes. Characters in `Cs...` separate lexemes and are skipped 16 at
+/// a time with SSE2. At each lexeme, entries `Es...` are tried in order and the first one that
+/// matches wins, like `|`. Only entries that can begin with the current character are tried,
+/// which is looked up in a table built at compile time.
+template<char... Cs, class... Es>
+struct Lexer<One<Cs...>, Es...> {
+    static_assert(sizeof...(Es) <= 64, "too many entries");
+
+    /// Tokenize `[begin, end)` into `out`. Return `end`, or the position where no entry matches.
+    [[nodiscard]] const char* tokenize(const char* begin,
+                                       const char* end,
+                                       TokenStream& out) const {
+        out.reset(begin, end);
+        BinaryInput in(begin, end);
+        // `State` keeps a reference to the options, which must outlive it.
+        ParseOptions opts;
+        ::qcpc::detail::State st(opts, begin);
+        Token::Children scratch;
+        while (true) {
+            in.advance_to(::qcpc::detail::skip_any<Cs...>(in.current(), end));
+            if (in.is_eoi()) return end;
+            const char* start = in.current();
+            if (!match(in, scratch, st, out, std::index_sequence_for<Es...>{})) return start;
+            scratch.clear();
+            // Lexemes never backtrack, so the memo before them is useless.
+            st.commit(in.current());
+        }
+    }
+
+  private:
+    constexpr static std::array<uint64_t, 256> candidates = [] {
+        std::array<uint64_t, 256> ret{};
+        size_t i = 0;
+        ((detail::add_candidate<typename Es::Rule>(ret, i++)), ...);
+        return ret;
+    }();
+
+    template<size_t... Is>
+    static bool match(BinaryInput& in,
+                      Token::Children& scratch,
+                      ::qcpc::detail::State& st,
+                      TokenStream& out,
+                      std::index_sequence<Is...>) {
+        uint64_t bits = candidates[static_cast<unsigned char>(*in)];
+        return ((bits >> Is & 1 && try_entry<Es>(in, scratch, st, out)) || ...);
+    }
+
+    template<class E>
+    static bool try_entry(BinaryInput& in,
+                          Token::Children& scratch,
+                          ::qcpc::detail::State& st,
+                          TokenStream& out) {
+        const char* start = in.current();
+        // An empty lexeme would never make progress.
+        if (!E::Rule::parse(in, scratch, st) || in.current() == start) return false;
+        if constexpr (!E::is_skipped) out.push(E::kind, start, in.current());
+        return true;
+    }
+};
+
+/// Make a lexer skipping characters of `one<Cs...>` between lexemes, which are matched by `Es...`,
+/// made with `define<K>(rule)` and `skip(rule)`.
+template<char... Cs, class... Es>
+[[nodiscard]] constexpr Lexer<One<Cs...>, Es...> lexer(One<Cs...>, Es...) {
+    return {};
+}
+
+}  // namespace qcpc::lex
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../input/input.hpp"
+#include "../parser/result.hpp"
+#include "../parser/token.hpp"
+
+namespace qcpc::lex {
+
+/// Where a lexeme is in the source text.
+struct Lexeme {
+    size_t offset;
+    size_t length;
+};
+
+/// The lexemes of a source text, produced by `Lexer::tokenize`. Kinds are stored apart from
+/// lexemes, one byte each, so that rules run over them like over characters.
+class TokenStream {
+  public:
+    TokenStream() = default;
+
+    /// Remove all lexemes and refer to a new source text.
+    void reset(const char* source, const char* source_end) {
+        this->_source = source;
+        this->_source_end = source_end;
+        this->_kinds.clear();
+        this->_lexemes.clear();
+    }
+
+    void push(char kind, const char* begin, const char* end) {
+        this->_kinds.push_back(kind);
+        this->_lexemes.push_back(
+            {static_cast<size_t>(begin - this->_source), static_cast<size_t>(end - begin)});
+    }
+
+    /// Return number of lexemes.
+    [[nodiscard]] size_t size() const noexcept {
+        return this->_lexemes.size();
+    }
+
+    /// Return the kinds of all lexemes, which `TokenStreamInput` parses.
+    [[nodiscard]] std::string_view kinds() const noexcept {
+        return this->_kinds;
+    }
+
+    [[nodiscard]] char kind(size_t i) const noexcept {
+        return this->_kinds[i];
+    }
+
+    [[nodiscard]] const Lexeme& lexeme(size_t i) const noexcept {
+        return this->_lexemes[i];
+    }
+
+    /// Return the source text of the `i`-th lexeme.
+    [[nodiscard]] std::string_view text(size_t i) const noexcept {
+        return {this->_source + this->_lexemes[i].offset, this->_lexemes[i].length};
+    }
+
+    /// Return the index of the lexeme at `p`, a position in `kinds()`, e.g. `token.begin()` of a
+    /// token parsed from a `TokenStreamInput`.
+    [[nodiscard]] size_t index(const char* p) const noexcept {
+        return p - this->_kinds.data();
+    }
+
+    /// Return the source text spanned by `token`, from its first lexeme to its last one. An empty
+    /// token gives an empty view where its position is.
+    [[nodiscard]] std::string_view text(const Token& token) const noexcept {
+        size_t first = this->index(token.begin());
+        size_t last = this->index(token.end());
+        const char* begin = this->_source_at(first);
+        if (first == last) return {begin, 0};
+        const Lexeme& back = this->_lexemes[last - 1];
+        return {begin, this->_source + back.offset + back.length};
+    }
+
+    /// Return the line and column in the source text of the lexeme at `p`, a position in
+    /// `kinds()`. The source is scanned from its beginning, so it is meant for reporting.
+    [[nodiscard]] InputPos source_pos(const char* p) const noexcept {
+        const char* target = this->_source_at(this->index(p));
+        InputPos ret{this->_source, 1, 0};
+        for (; ret.current != target; ++ret.current) {
+            if (*ret.current == '\n') {
+                ret.line += 1;
+                ret.column = 0;
+            } else {
+                ret.column += 1;
+            }
+        }
+        return ret;
+    }
+
+    /// Translate the line and column of an error of a parse over this stream, counted in kinds,
+    /// to ones in the source text.
+    void locate(ParseError& error) const noexcept {
+        InputPos pos = this->source_pos(error.position);
+        error.line = pos.line;
+        error.column = pos.column;
+    }
+
+  private:
+    const char* _source = "";
+    const char* _source_end = _source;
+    std::string _kinds;
+    std::vector<Lexeme> _lexemes;
+
+    [[nodiscard]] const char* _source_at(size_t i) const noexcept {
+        return i < this->size() ? this->_source + this->_lexemes[i].offset : this->_source_end;
+    }
+};
+
+/// An input over the kinds of a `TokenStream`. Each lexeme is one character, so rules match
+/// lexemes: `one<'('>` is a `(` lexeme if punctuation uses itself as kind, and `lex::kind<K>`
+/// is a lexeme of kind `K`. The stream must outlive the input and tokens parsed from it.
+///
+/// Lines and columns are not tracked. Use `TokenStream::text` and `TokenStream::locate` to get
+/// back to the source text.
+struct TokenStreamInput: InputCRTP<TokenStreamInput> {
+    constexpr static bool tracks_lines = false;
+
+    explicit TokenStreamInput(const TokenStream& stream) noexcept
+        : InputCRTP<TokenStreamInput>(stream.kinds().data(),
+                                      stream.kinds().data() + stream.kinds().size()),
+          _stream(&stream) {}
+
+    [[nodiscard]] const TokenStream& stream() const noexcept {
+        return *this->_stream;
+    }
+
+  private:
+    const TokenStream* _stream;
+};
+
+}  // namespace qcpc::lex
@@ -2,12 +2,15 @@
 
 #include <concepts>
 #include <memory>
-#include <optional>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
+#include "result.hpp"
+#include "rule_index.hpp"
 #include "rule_tag.hpp"
 #include "rules/rules.hpp"
+#include "state.hpp"
 #include "token.hpp"
 
 namespace qcpc {
@@ -22,50 +25,68 @@ concept GeneratedRule = std::derived_from<T, GeneratedTag>;
 template<class>
 inline constexpr int rule_set = 0;
 
+template<GeneratedRule R>
+struct FirstChars<R>: FirstChars<std::remove_cvref_t<decltype(rule_set<R>)>> {};
+
 }  // namespace detail
 
 #define QCPC_DETAIL_MANGLE(name) QCPC_GeneratedRule_##name
 
-#define QCPC_DETAIL_DECL(name, silent)                                                           \
-    struct QCPC_DETAIL_MANGLE(name): ::qcpc::detail::GeneratedTag {                              \
-        using Self = QCPC_DETAIL_MANGLE(name);                                                   \
+#define QCPC_DETAIL_DECL(rule_name, silent, collapse)                                            \
+    struct QCPC_DETAIL_MANGLE(rule_name): ::qcpc::detail::GeneratedTag {                         \
+        using Self = QCPC_DETAIL_MANGLE(rule_name);                                              \
                                                                                                  \
         constexpr static bool is_silent = silent;                                                \
+        constexpr static bool is_inline = collapse;                                              \
+        constexpr static std::string_view name = #rule_name;                                     \
         constexpr static auto tag = silent ? ::qcpc::NO_RULE : ::qcpc::detail::rule_tag<Self>(); \
                                                                                                  \
         /* The use of the inline variable here is IFNDR. */                                      \
         template<::qcpc::InputType Input, class Lazy = Self>                                     \
         friend bool parse_detail(Input& in,                                                      \
                                  ::qcpc::Token::Children& out,                                   \
-                                 ::qcpc::detail::MemMap mem,                                     \
+                                 ::qcpc::detail::State& st,                                      \
                                  Self) {                                                         \
             const auto rule = ::qcpc::detail::rule_set<Lazy>;                                    \
+            /* Only generated rules can recurse, so guarding them bounds the depth. */           \
+            if (!st.enter()) return false;                                                       \
+            bool res;                                                                            \
             if constexpr (is_silent) {                                                           \
-                return rule.parse(in, out, mem);                                                 \
+                res = rule.parse(in, out, st);                                                   \
             } else {                                                                             \
-                ::qcpc::Token::Children children{};                                              \
+                ::qcpc::Token::Children children(st.resource());                                 \
                 auto pos = in.pos();                                                             \
-                bool res = rule.parse(in, children, mem);                                        \
-                if (res) out.push_back({std::move(children), {pos, in.current()}, tag});         \
-                return res;                                                                      \
+                res = rule.parse(in, children, st);                                              \
+                if (!res)                                                                        \
+                    st.expect_rule(pos.current, name);                                           \
+                else if (is_inline && children.size() == 1)                                      \
+                    out.push_back(std::move(children[0]));                                       \
+                else                                                                             \
+                    out.push_back({std::move(children), {pos, in.current()}, tag});              \
             }                                                                                    \
+            st.leave();                                                                          \
+            return res;                                                                          \
         }                                                                                        \
                                                                                                  \
         template<::qcpc::InputType Input>                                                        \
         static bool parse(Input& in,                                                             \
                           ::qcpc::Token::Children& out,                                          \
-                          ::qcpc::detail::MemMap mem) noexcept {                                 \
-            return parse_detail(in, out, mem, Self{});                                           \
+                          ::qcpc::detail::State& st) noexcept {                                  \
+            return parse_detail(in, out, st, Self{});                                            \
         }                                                                                        \
     };                                                                                           \
                                                                                                  \
-    inline constexpr QCPC_DETAIL_MANGLE(name) name {}
+    inline constexpr QCPC_DETAIL_MANGLE(rule_name) rule_name {}
 
 /// Declare a regular rule.
-#define QCPC_DECL(name) QCPC_DETAIL_DECL(name, false)
+#define QCPC_DECL(name) QCPC_DETAIL_DECL(name, false, false)
 
 /// Declare a silent rule.
-#define QCPC_DECL_(name) QCPC_DETAIL_DECL(name, true)
+#define QCPC_DECL_(name) QCPC_DETAIL_DECL(name, true, false)
+
+/// Declare a rule whose token is replaced by its child if it has exactly one, so that pass-through
+/// rules like `expr = sum` do not add a level to the tree.
+#define QCPC_DECL_INLINE(name) QCPC_DETAIL_DECL(name, false, true)
 
 /// Define a rule. The name must be declared by `QCPC_DECL` before.
 #define QCPC_DEF(name) \
@@ -82,16 +103,42 @@ inline constexpr int rule_set = 0;
     QCPC_DECL_(name);        \
     QCPC_DEF(name)
 
+/// A convenient macro that combines `QCPC_DECL_INLINE` and `QCPC_DEF`.
+#define QCPC_DECL_DEF_INLINE(name) \
+    QCPC_DECL_INLINE(name);        \
+    QCPC_DEF(name)
+
 /// The sole parsing entry for users. It does not allow `Input&&` because the returned `Token`s
 /// holds views into the input object, so it must outlive the parse function.
 template<detail::GeneratedRule Rule, InputType Input>
-std::optional<Token> parse(Rule, Input& in) requires(!Rule::is_silent) {
-    Token::Children children{};
-    detail::MemMap mem{};
-    if (Rule::parse(in, children, mem))
-        return std::move(children[0]);
-    else
-        return std::nullopt;
+ParseResult parse(Rule, Input& in, const ParseOptions& opts = {}) requires(!Rule::is_silent) {
+    // Inputs sharing a representation share rule instantiations.
+    typename Input::ParseAs& base = in;
+    auto pos = in.pos();
+    detail::State st(opts, pos.current, Input::is_utf8);
+    Token::Children children(st.resource());
+    bool res = Rule::parse(base, children, st);
+    if constexpr (Input::is_segmented) {
+        // Positions are not contiguous, so the input locates errors.
+        if (res && st.reason() == AbortReason::None && !st.failed_hard()) {
+            auto diagnostics = st.diagnostics(children[0]);
+            for (auto& error: diagnostics) in.locate(error);
+            return {std::move(children[0]), std::move(diagnostics)};
+        }
+        in.jump(pos);
+        if (st.reason() != AbortReason::None) return st.reason();
+        auto error = st.error();
+        in.locate(error);
+        return error;
+    } else {
+        if (res && st.reason() == AbortReason::None && !st.failed_hard()) {
+            auto diagnostics = st.diagnostics(children[0], pos);
+            return {std::move(children[0]), std::move(diagnostics)};
+        }
+        in.jump(pos);
+        if (st.reason() != AbortReason::None) return st.reason();
+        return st.error(pos);
+    }
 }
 
 }  // namespace qcpc
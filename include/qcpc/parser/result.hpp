@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "token.hpp"
+
+namespace qcpc {
+
+enum class ParseStatus : uint8_t {
+    Success,   ///< The input matches.
+    Mismatch,  ///< The input does not match.
+    Aborted,   ///< The parse stopped before knowing, see `AbortReason`.
+};
+
+enum class AbortReason : uint8_t {
+    None,        ///< Not aborted.
+    TooDeep,     ///< Exceeded `ParseOptions::max_depth` or `ParseOptions::stack_budget`.
+    OutOfSteps,  ///< Exceeded `ParseOptions::max_steps`.
+    Timeout,     ///< Passed `ParseOptions::deadline`.
+    Cancelled,   ///< `ParseOptions::cancel` was set.
+};
+
+/// Something the parser expected at the farthest failure.
+struct Expected {
+    /// A rule name, or a terminal description like `'a'`, `"abc"`, `[0-9]` or "end of input".
+    std::string_view name;
+    bool is_rule;
+};
+
+/// Where and why the input does not match: the farthest position any terminal failed at, and
+/// what was expected there. Failures inside predicates are not counted.
+struct ParseError {
+    const char* position = nullptr;
+    size_t line = 1;
+    size_t column = 0;
+    std::vector<Expected> expected;
+
+    /// Return a message like "2:7: expected value, [0-9] or '('".
+    [[nodiscard]] std::string message() const {
+        std::string ret = std::to_string(this->line) + ':' + std::to_string(this->column) + ": ";
+        if (this->expected.empty()) return ret + "unexpected input";
+        ret += "expected ";
+        for (size_t i = 0; i < this->expected.size(); ++i) {
+            if (i != 0) ret += i + 1 == this->expected.size() ? " or " : ", ";
+            ret += this->expected[i].name;
+        }
+        return ret;
+    }
+};
+
+/// Result of a parse. Like `std::optional<Token>`, it converts to `true` and dereferences to the
+/// root `Token` on success. On failure, it tells a mismatch from an aborted parse.
+class ParseResult {
+  public:
+    ParseResult(Token token, std::vector<ParseError> diagnostics = {}) noexcept
+        : _token(std::move(token)), _diagnostics(std::move(diagnostics)) {}
+
+    ParseResult(ParseError error) noexcept
+        : _error(std::move(error)), _status(ParseStatus::Mismatch) {}
+
+    ParseResult(AbortReason reason) noexcept: _status(ParseStatus::Aborted), _reason(reason) {}
+
+    [[nodiscard]] explicit operator bool() const noexcept {
+        return this->_status == ParseStatus::Success;
+    }
+
+    [[nodiscard]] bool has_value() const noexcept {
+        return this->_status == ParseStatus::Success;
+    }
+
+    [[nodiscard]] Token& operator*() noexcept {
+        return *this->_token;
+    }
+
+    [[nodiscard]] const Token& operator*() const noexcept {
+        return *this->_token;
+    }
+
+    [[nodiscard]] Token* operator->() noexcept {
+        return &*this->_token;
+    }
+
+    [[nodiscard]] const Token* operator->() const noexcept {
+        return &*this->_token;
+    }
+
+    [[nodiscard]] ParseStatus status() const noexcept {
+        return this->_status;
+    }
+
+    [[nodiscard]] bool is_aborted() const noexcept {
+        return this->_status == ParseStatus::Aborted;
+    }
+
+    /// Return why the parse was aborted, or `AbortReason::None`.
+    [[nodiscard]] AbortReason reason() const noexcept {
+        return this->_reason;
+    }
+
+    /// Return where and why the input does not match. Only meaningful on mismatch.
+    [[nodiscard]] const ParseError& error() const noexcept {
+        return this->_error;
+    }
+
+    /// Return errors recovered by `recover` on success, in input order.
+    [[nodiscard]] const std::vector<ParseError>& diagnostics() const noexcept {
+        return this->_diagnostics;
+    }
+
+  private:
+    std::optional<Token> _token;
+    ParseError _error;
+    std::vector<ParseError> _diagnostics;
+    ParseStatus _status = ParseStatus::Success;
+    AbortReason _reason = AbortReason::None;
+};
+
+}  // namespace qcpc
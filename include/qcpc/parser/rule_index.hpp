@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#include "rule_tag.hpp"
+#include "token.hpp"
+
+namespace qcpc {
+
+namespace detail {
+
+[[nodiscard]] constexpr size_t ceil_log2(size_t n) noexcept {
+    size_t bits = 0;
+    while ((size_t(1) << bits) < n) ++bits;
+    return bits;
+}
+
+void perfect_hash_not_found();  // not constexpr, reaching it is a compile error
+
+/// A minimal perfect hash from `N` distinct tags to `[0, N)`, built at compile time by hash and
+/// displace: tags are split into buckets, then every bucket is assigned a seed under which all of
+/// its tags land in empty slots. A lookup costs two multiplications and two loads.
+template<size_t N>
+struct DenseTable {
+    constexpr static size_t npos = N;
+    constexpr static size_t bucket_bits = ceil_log2(N);
+    constexpr static size_t slot_bits = ceil_log2(N) + 1;  // load factor <= 1/2
+
+    std::array<uint32_t, size_t(1) << bucket_bits> seeds{};
+    std::array<RuleTag, size_t(1) << slot_bits> keys{};
+    std::array<uint32_t, size_t(1) << slot_bits> ids{};
+    bool duplicated = false;
+
+    consteval explicit DenseTable(const std::array<RuleTag, N>& tags) {
+        for (auto& key: this->keys) key = NO_RULE;
+        for (auto& id: this->ids) id = npos;
+
+        // Group ids by bucket (counting sort).
+        constexpr size_t bucket_count = size_t(1) << bucket_bits;
+        std::array<size_t, bucket_count + 1> start{};
+        for (RuleTag tag: tags) start[bucket(tag) + 1] += 1;
+        for (size_t b = 0; b < bucket_count; ++b) start[b + 1] += start[b];
+        std::array<size_t, N> members{};
+        auto fill = start;
+        for (size_t i = 0; i < N; ++i) members[fill[bucket(tags[i])]++] = i;
+
+        // Equal tags always fall into the same bucket.
+        size_t max_size = 0;
+        for (size_t b = 0; b < bucket_count; ++b) {
+            for (size_t i = start[b]; i < start[b + 1]; ++i) {
+                for (size_t j = start[b]; j < i; ++j) {
+                    if (tags[members[i]] == tags[members[j]]) this->duplicated = true;
+                }
+            }
+            if (start[b + 1] - start[b] > max_size) max_size = start[b + 1] - start[b];
+        }
+        if (this->duplicated) return;
+
+        // Place larger buckets first, they are harder to place.
+        for (size_t size = max_size; size > 0; --size) {
+            for (size_t b = 0; b < bucket_count; ++b) {
+                if (start[b + 1] - start[b] != size) continue;
+                this->place(tags, b, &members[start[b]], size);
+            }
+        }
+    }
+
+    [[nodiscard]] constexpr size_t find(RuleTag tag) const noexcept {
+        size_t s = slot(tag, this->seeds[bucket(tag)]);
+        return this->keys[s] == tag ? this->ids[s] : npos;
+    }
+
+  private:
+    [[nodiscard]] constexpr static size_t bucket(RuleTag tag) noexcept {
+        if constexpr (bucket_bits == 0)
+            return 0;
+        else
+            return (tag * 0x9e3779b97f4a7c15ull) >> (64 - bucket_bits);
+    }
+
+    [[nodiscard]] constexpr static size_t slot(RuleTag tag, uint64_t seed) noexcept {
+        uint64_t mixed = (tag ^ (seed * 0xc2b2ae3d27d4eb4full)) * 0xff51afd7ed558ccdull;
+        return mixed >> (64 - slot_bits);
+    }
+
+    consteval void place(const std::array<RuleTag, N>& tags,
+                         size_t b,
+                         const size_t* members,
+                         size_t size) {
+        for (uint32_t seed = 0; seed < (1u << 20); ++seed) {
+            bool ok = true;
+            for (size_t i = 0; ok && i < size; ++i) {
+                size_t s = slot(tags[members[i]], seed);
+                ok = this->keys[s] == NO_RULE;
+                for (size_t j = 0; ok && j < i; ++j) ok = s != slot(tags[members[j]], seed);
+            }
+            if (!ok) continue;
+            for (size_t i = 0; i < size; ++i) {
+                size_t s = slot(tags[members[i]], seed);
+                this->keys[s] = tags[members[i]];
+                this->ids[s] = static_cast<uint32_t>(members[i]);
+            }
+            this->seeds[b] = seed;
+            return;
+        }
+        perfect_hash_not_found();
+    }
+};
+
+/// Return the position of `R` in `Rs`, or `sizeof...(Rs)` if not found.
+template<class R, class... Rs>
+consteval size_t index_of() noexcept {
+    size_t ret = sizeof...(Rs), i = 0;
+    ((std::is_same_v<std::remove_cvref_t<R>, std::remove_cvref_t<Rs>> ? ret = i++ : i++), ...);
+    return ret;
+}
+
+}  // namespace detail
+
+/// Assign dense ids `0..N-1` to `N` regular rules in the given order, e.g.
+/// `RuleIndex<expr, value, sum>` gives `expr` 0, `value` 1 and `sum` 2.
+///
+/// Unlike tags, which are sparse 64-bit hashes, dense ids can index flat arrays and make
+/// `switch (Index::of(token))` compile to a jump table.
+template<auto... Rules>
+struct RuleIndex {
+    /// Number of rules. It is also the id of unknown tags.
+    constexpr static size_t size = sizeof...(Rules);
+
+    /// Tags of the rules, indexed by id.
+    constexpr static std::array<RuleTag, size> tags = {
+        std::remove_cvref_t<decltype(Rules)>::tag...};
+
+    /// Names of the rules, indexed by id.
+    constexpr static std::array<std::string_view, size> names = {
+        std::remove_cvref_t<decltype(Rules)>::name...};
+
+    /// Id of the given rule.
+    template<auto Rule>
+    requires(detail::index_of<decltype(Rule), decltype(Rules)...>() != size)
+    constexpr static size_t id = detail::index_of<decltype(Rule), decltype(Rules)...>();
+
+    /// Return id of the given tag, or `size` if the tag does not belong to these rules.
+    [[nodiscard]] constexpr static size_t of(RuleTag tag) noexcept {
+        return table.find(tag);
+    }
+
+    /// Return id of the rule which produced the given token, or `size` if it is not one of
+    /// these rules.
+    [[nodiscard]] constexpr static size_t of(const Token& token) noexcept {
+        return table.find(token.tag());
+    }
+
+  private:
+    static_assert(size > 0, "empty rule index");
+    static_assert(((!std::remove_cvref_t<decltype(Rules)>::is_silent) && ...),
+                  "silent rules produce no tokens, so they have no ids");
+
+    constexpr static detail::DenseTable<size> table{tags};
+    static_assert(!table.duplicated, "duplicate rules");
+};
+
+}  // namespace qcpc
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <limits>
 #include <string_view>
 
 namespace qcpc {
@@ -8,8 +9,20 @@ using RuleTag = size_t;
 
 inline constexpr RuleTag NO_RULE = std::numeric_limits<RuleTag>::max();
 
+/// Tag of error tokens produced by `recover`.
+inline constexpr RuleTag ERROR_RULE = NO_RULE - 1;
+
 namespace detail {
 
+/// FNV-1a hash.
+[[nodiscard]] constexpr RuleTag fnv1a(std::string_view str) noexcept {
+    constexpr RuleTag FNV_BASIS = 14695981039346656037ull;
+    constexpr RuleTag FNV_PRIME = 1099511628211ull;
+    RuleTag hash = FNV_BASIS;
+    for (char c: str) hash = (hash ^ c) * FNV_PRIME;
+    return hash;
+}
+
 template<typename T>  // Can not remove `T` here
 consteval RuleTag rule_tag() {
     // Get a string that contains type name of T from a special variable / macro
@@ -21,12 +34,7 @@ consteval RuleTag rule_tag() {
     #error "No support for this compiler."
 #endif
 
-    // FNV-1a hash
-    constexpr RuleTag FNV_BASIS = 14695981039346656037ull;
-    constexpr RuleTag FNV_PRIME = 1099511628211ull;
-    RuleTag hash = FNV_BASIS;
-    for (char c: name) hash = (hash ^ c) * FNV_PRIME;
-    return hash;
+    return fnv1a(name);
 }
 
 }  // namespace detail
@@ -1,7 +1,5 @@
 #pragma once
 
-#include <utility>
-
 #include "header.hpp"
 
 namespace qcpc {
@@ -11,48 +9,102 @@ namespace qcpc {
 template<char... Cs>
 struct One {
     QCPC_DETAIL_DEFINE_PARSE(One) {
-        if (((*in == Cs) || ...)) {
+        // The padding after the end of input is zeros, which do not match.
+        constexpr bool unchecked = Input::padding > 0 && ((Cs != '\0') && ...);
+        if ((unchecked || !in.is_eoi()) && ((*in == Cs) || ...)) {
             ++in;
             return true;
         }
         return false;
     }
+
+    constexpr static auto expected = [] {
+        detail::Description<4 * sizeof...(Cs) + 2> ret;
+        if constexpr (sizeof...(Cs) == 1) {
+            ret.push('\'');
+            (ret.push_escaped(Cs, "'"), ...);
+            ret.push('\'');
+        } else {
+            ret.push('[');
+            (ret.push_escaped(Cs, "[]-^"), ...);
+            ret.push(']');
+        }
+        return ret;
+    }();
 };
 
 template<char... Cs>
 inline constexpr One<Cs...> one{};
 
+/// Match and consume any character once. Fail only at the end of input.
+/// `any` means `.` in PEG.
+struct Any {
+    QCPC_DETAIL_DEFINE_PARSE(Any) {
+        if (in.is_eoi()) return false;
+        ++in;
+        return true;
+    }
+
+    constexpr static std::string_view expected = "any character";
+};
+
+inline constexpr Any any{};
+
 /// Match and consume given string.
 /// `str<'a', 'b', 'c', 'd'>` means `"abcd"` in PEG.
 /// `QCPC_STR("abcd")` means `"abcd"` in PEG.
-template<char... Cs>
+template<detail::FixedString S>
 struct Str {
-    // Waiting for complete support of "Class Types in Non-Type Template Parameters" feature.
-    // With this feature, we can pass a string literal as a template parameter.
-
     QCPC_DETAIL_DEFINE_PARSE(Str) {
-        if (in.size() < sizeof...(Cs)) return false;
-        auto current = in.current();
-        if (((Cs == *current++) && ...)) {
-            in.advance(sizeof...(Cs));
-            return true;
+        const char* current;
+        if constexpr (Input::padding >= S.size() && !has_nul()) {
+            // A mismatch is found in the padding at the latest.
+            current = in.current();
+        } else {
+            current = in.contiguous(S.size());
+            if (!current) return false;
+        }
+        for (size_t i = 0; i < S.size(); ++i) {
+            if (current[i] != S[i]) return false;
+        }
+        in.advance(S.size());
+        return true;
+    }
+
+    constexpr static auto expected = [] {
+        detail::Description<4 * S.size() + 2> ret;
+        ret.push('"');
+        for (size_t i = 0; i < S.size(); ++i) ret.push_escaped(S[i], "\"");
+        ret.push('"');
+        return ret;
+    }();
+
+  private:
+    [[nodiscard]] consteval static bool has_nul() noexcept {
+        for (size_t i = 0; i < S.size(); ++i) {
+            if (S[i] == '\0') return true;
         }
         return false;
     }
 };
 
-template<char... Cs>
-inline constexpr Str<Cs...> str{};
+namespace detail {
 
-// Optimization
-template<char C>
-inline constexpr One<C> str<C>{};
+template<FixedString S>
+consteval auto make_str() noexcept {
+    // Optimization
+    if constexpr (S.size() == 1)
+        return One<S[0]>{};
+    else
+        return Str<S>{};
+}
 
-#define QCPC_STR(s)                                \
-    []<size_t... Is>(std::index_sequence<Is...>) { \
-        return ::qcpc::str<(s)[Is]...>;            \
-    }                                              \
-    (std::make_index_sequence<sizeof(s) - 1>{})
+}  // namespace detail
+
+template<char... Cs>
+inline constexpr auto str = detail::make_str<detail::FixedString<sizeof...(Cs)>({Cs..., '\0'})>();
+
+#define QCPC_STR(s) (::qcpc::detail::make_str<s>())
 
 /// Match and consume a character in given ASCII range(s).
 /// `range<'a', 'z', 'A', 'Z'>` means `[a-zA-Z]` in PEG.
@@ -60,25 +112,51 @@ inline constexpr One<C> str<C>{};
 template<char... Cs>
 struct Range {
     QCPC_DETAIL_DEFINE_PARSE(Range) {
-        bool res = []<size_t... Is>(std::index_sequence<Is...>, char c) {
-            constexpr char cs[] = {Cs...};
-            constexpr size_t len = sizeof...(Cs);
-            if constexpr (len % 2 == 0)
-                return (check_range<cs[2 * Is], cs[2 * Is + 1]>(c) || ...);
-            else
-                return (check_range<cs[2 * Is], cs[2 * Is + 1]>(c) || ...) || c == cs[len - 1];
+        static_assert(check_ranges(), "invalid range");
+
+        if constexpr (Input::padding == 0 || matches_nul()) {
+            if (in.is_eoi()) return false;
         }
-        (std::make_index_sequence<sizeof...(Cs) / 2>{}, *in);
+        char c = *in;
+        bool res = false;
+        for (size_t i = 0; i + 1 < len; i += 2) res |= cs[i] <= c && c <= cs[i + 1];
+        if constexpr (len % 2 == 1) res |= c == cs[len - 1];
 
         if (res) ++in;
         return res;
     }
 
+    constexpr static auto expected = [] {
+        constexpr char chars[] = {Cs...};
+        constexpr size_t size = sizeof...(Cs);
+        detail::Description<4 * size + 2 + size / 2> ret;
+        ret.push('[');
+        for (size_t i = 0; i + 1 < size; i += 2) {
+            ret.push_escaped(chars[i], "[]-^");
+            ret.push('-');
+            ret.push_escaped(chars[i + 1], "[]-^");
+        }
+        if constexpr (size % 2 == 1) ret.push_escaped(chars[size - 1], "[]-^");
+        ret.push(']');
+        return ret;
+    }();
+
   private:
-    template<char L, char R>
-    [[nodiscard]] constexpr static bool check_range(char c) noexcept {
-        static_assert(L <= R, "invalid range");
-        return L <= c && c <= R;
+    constexpr static char cs[] = {Cs...};
+    constexpr static size_t len = sizeof...(Cs);
+
+    [[nodiscard]] consteval static bool check_ranges() noexcept {
+        for (size_t i = 0; i + 1 < len; i += 2) {
+            if (cs[i] > cs[i + 1]) return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] consteval static bool matches_nul() noexcept {
+        for (size_t i = 0; i + 1 < len; i += 2) {
+            if (cs[i] <= '\0' && '\0' <= cs[i + 1]) return true;
+        }
+        return len % 2 == 1 && cs[len - 1] == '\0';
     }
 };
 
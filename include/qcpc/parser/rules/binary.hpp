@@ -0,0 +1,249 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+#include "header.hpp"
+
+namespace qcpc::binary {
+
+namespace detail {
+
+/// Push the decimal digits of `n`.
+template<size_t N>
+constexpr void push_number(::qcpc::detail::Description<N>& desc, size_t n) noexcept {
+    if (n >= 10) push_number(desc, n / 10);
+    desc.push(static_cast<char>('0' + n % 10));
+}
+
+/// Return the value of the integer matched by `R` from `begin` to the current position.
+template<class R, class Input>
+[[nodiscard]] uint64_t matched_value(const Input& in, const char* begin) {
+    if constexpr (Input::is_segmented) {
+        return R::value(in.text(begin, in.current()));
+    } else {
+        return R::value({begin, in.current()});
+    }
+}
+
+}  // namespace detail
+
+/// Rules whose matches have an integer value, e.g. counts and lengths.
+template<class R>
+concept IntegerRule = RuleType<R> && requires(std::string_view bytes) {
+    { R::value(bytes) } -> std::same_as<uint64_t>;
+};
+
+/// Match and consume any `N` bytes.
+/// `binary::any<4>` means `....` in PEG.
+template<size_t N>
+struct Any {
+    QCPC_DETAIL_DEFINE_PARSE(Any) {
+        if (in.size() < N) return false;
+        in.advance(N);
+        return true;
+    }
+
+    constexpr static auto expected = [] {
+        ::qcpc::detail::Description<32> ret;
+        detail::push_number(ret, N);
+        for (char c: std::string_view(N == 1 ? " byte" : " bytes")) ret.push(c);
+        return ret;
+    }();
+};
+
+template<size_t N>
+inline constexpr Any<N> any{};
+
+/// Match and consume given bytes.
+/// `binary::bytes<0x89, 'P', 'N', 'G'>` means `"\x89PNG"` in PEG.
+template<uint8_t... Bs>
+struct Bytes {
+    QCPC_DETAIL_DEFINE_PARSE(Bytes) {
+        constexpr uint8_t bytes[] = {Bs...};
+        auto current = in.contiguous(sizeof...(Bs));
+        if (!current) return false;
+        for (size_t i = 0; i < sizeof...(Bs); ++i) {
+            if (static_cast<uint8_t>(current[i]) != bytes[i]) return false;
+        }
+        in.advance(sizeof...(Bs));
+        return true;
+    }
+
+    constexpr static auto expected = [] {
+        ::qcpc::detail::Description<4 * sizeof...(Bs) + 2> ret;
+        ret.push('"');
+        (ret.push_escaped(static_cast<char>(Bs), "\""), ...);
+        ret.push('"');
+        return ret;
+    }();
+};
+
+template<uint8_t... Bs>
+inline constexpr Bytes<Bs...> bytes{};
+
+/// Match and consume an unsigned integer of `N` bytes in the given byte order.
+template<size_t N, std::endian E>
+struct UInt {
+    static_assert(N == 1 || N == 2 || N == 4 || N == 8, "invalid integer size");
+
+    QCPC_DETAIL_DEFINE_PARSE(UInt) {
+        if (in.size() < N) return false;
+        in.advance(N);
+        return true;
+    }
+
+    /// Return the value of matched bytes, e.g. `binary::u32le.value(token.view())`.
+    [[nodiscard]] constexpr static uint64_t value(std::string_view bytes) noexcept {
+        // Compiles to a load, and a byte swap if needed.
+        uint64_t ret = 0;
+        for (size_t i = 0; i < N; ++i) {
+            auto byte = static_cast<uint8_t>(bytes[E == std::endian::big ? i : N - 1 - i]);
+            ret = ret << 8 | byte;
+        }
+        return ret;
+    }
+
+    constexpr static auto expected = [] {
+        ::qcpc::detail::Description<8> ret;
+        ret.push('u');
+        detail::push_number(ret, N * 8);
+        if constexpr (N != 1) {
+            ret.push(E == std::endian::big ? 'b' : 'l');
+            ret.push('e');
+        }
+        return ret;
+    }();
+};
+
+inline constexpr UInt<1, std::endian::little> u8{};
+inline constexpr UInt<2, std::endian::little> u16le{};
+inline constexpr UInt<2, std::endian::big> u16be{};
+inline constexpr UInt<4, std::endian::little> u32le{};
+inline constexpr UInt<4, std::endian::big> u32be{};
+inline constexpr UInt<8, std::endian::little> u64le{};
+inline constexpr UInt<8, std::endian::big> u64be{};
+
+/// Match and consume an unsigned LEB128 integer of at most 64 bits, as used by Protocol Buffers
+/// and WebAssembly.
+struct Varint {
+    constexpr static size_t MAX_SIZE = 10;
+
+    QCPC_DETAIL_DEFINE_PARSE(Varint) {
+        size_t limit = in.size() < MAX_SIZE ? in.size() : MAX_SIZE;
+        auto current = in.contiguous(limit);
+        for (size_t i = 0; i < limit; ++i) {
+            if ((static_cast<uint8_t>(current[i]) & 0x80) == 0) {
+                in.advance(i + 1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Return the value of matched bytes. Bits beyond 64 are dropped.
+    [[nodiscard]] constexpr static uint64_t value(std::string_view bytes) noexcept {
+        uint64_t ret = 0;
+        for (size_t i = 0; i < bytes.size(); ++i)
+            ret |= uint64_t(static_cast<uint8_t>(bytes[i]) & 0x7f) << (7 * i);
+        return ret;
+    }
+
+    constexpr static std::string_view expected = "varint";
+};
+
+inline constexpr Varint varint{};
+
+/// Match the integer `C`, then `R` exactly as many times as its value.
+/// If an iteration of `R` consumes and produces nothing, the remaining ones would do the same
+/// and are skipped.
+template<IntegerRule C, RuleType R>
+struct RepeatN {
+    QCPC_DETAIL_DEFINE_PARSE(RepeatN) {
+        auto pos = in.pos();
+        size_t size = out.size();
+        if (!C::parse(in, out, st)) return false;
+        uint64_t n = detail::matched_value<C>(in, pos.current);
+        for (uint64_t i = 0; i < n; ++i) {
+            const char* before = in.current();
+            size_t tokens = out.size();
+            if (!R::parse(in, out, st)) {
+                in.jump(pos);
+                out.erase(out.begin() + size, out.end());
+                return false;
+            }
+            if (in.current() == before && out.size() == tokens) break;
+        }
+        return true;
+    }
+};
+
+template<IntegerRule C, RuleType R>
+[[nodiscard]] constexpr RepeatN<C, R> repeat_n(C, R) {
+    return {};
+}
+
+/// Match the integer `L`, then skip as many bytes as its value, or match `Rs...` against exactly
+/// those bytes, as if they were the whole input.
+template<IntegerRule L, RuleType... Rs>
+struct LengthPrefixed {
+    static_assert(sizeof...(Rs) <= 1, "at most one body rule");
+
+    QCPC_DETAIL_DEFINE_PARSE(LengthPrefixed) {
+        auto pos = in.pos();
+        if (!L::parse(in, out, st)) return false;
+        uint64_t n = detail::matched_value<L>(in, pos.current);
+        if (n > in.size()) {
+            in.jump(pos);
+            return false;
+        }
+        if constexpr (sizeof...(Rs) == 0) {
+            if constexpr (Input::is_segmented) {
+                in.advance(n);
+            } else {
+                in.advance_to(in.current() + n);
+            }
+        } else {
+            static_assert(!Input::is_segmented, "body rules need a contiguous input");
+            const char* end = in.current() + n;
+            // Matches in the window may differ outside of it, e.g. `eoi`, so it gets its own memo.
+            size_t size = out.size();
+            ::qcpc::detail::MemMap mem(st.resource());
+            std::swap(mem, st.mem);
+            bool res;
+            if constexpr (Input::padding > 0) {
+                // Input rather than zeros follows the window, so it is parsed without padding.
+                ::qcpc::detail::Unpadded<Input> window(in.begin(), end);
+                window.jump(in.pos());
+                res = (Rs::parse(window, out, st) && ...) && window.is_eoi();
+                in.jump(window.pos());
+            } else {
+                const char* outer = in.exchange_end(end);
+                res = (Rs::parse(in, out, st) && ...) && in.is_eoi();
+                in.exchange_end(outer);
+            }
+            std::swap(mem, st.mem);
+            if (!res) {
+                in.jump(pos);
+                out.erase(out.begin() + size, out.end());
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+template<IntegerRule L>
+[[nodiscard]] constexpr LengthPrefixed<L> length_prefixed(L) {
+    return {};
+}
+
+template<IntegerRule L, RuleType R>
+[[nodiscard]] constexpr LengthPrefixed<L, R> length_prefixed(L, R) {
+    return {};
+}
+
+}  // namespace qcpc::binary
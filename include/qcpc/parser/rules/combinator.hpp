@@ -1,5 +1,8 @@
 #pragma once
 
+#include <tuple>
+#include <utility>
+
 #include "header.hpp"
 
 namespace qcpc {
@@ -9,7 +12,11 @@ template<RuleType R>
 struct At {
     QCPC_DETAIL_DEFINE_PARSE(At) {
         auto pos = in.pos();
-        auto ret = R::parse(in, out, mem);
+        auto floor = st.begin_choice(pos.current);
+        st.begin_quiet();
+        auto ret = R::parse(in, out, st);
+        st.end_quiet();
+        st.end_choice(floor);
         in.jump(pos);
         return ret;
     }
@@ -25,7 +32,11 @@ template<RuleType R>
 struct NotAt {
     QCPC_DETAIL_DEFINE_PARSE(NotAt) {
         auto pos = in.pos();
-        auto ret = R::parse(in, out, mem);
+        auto floor = st.begin_choice(pos.current);
+        st.begin_quiet();
+        auto ret = R::parse(in, out, st);
+        st.end_quiet();
+        st.end_choice(floor);
         in.jump(pos);
         return !ret;
     }
@@ -40,7 +51,9 @@ template<RuleType R>
 template<RuleType R>
 struct Opt {
     QCPC_DETAIL_DEFINE_PARSE(Opt) {
-        R::parse(in, out, mem);
+        auto floor = st.begin_choice(in.current());
+        R::parse(in, out, st);
+        st.end_choice(floor);
         return true;
     }
 };
@@ -54,7 +67,12 @@ template<RuleType R>
 template<RuleType R>
 struct Star {
     QCPC_DETAIL_DEFINE_PARSE(Star) {
-        while (R::parse(in, out, mem)) {}
+        auto floor = st.begin_choice(in.current());
+        while (R::parse(in, out, st)) {
+            st.end_choice(floor);
+            (void)st.begin_choice(in.current());
+        }
+        st.end_choice(floor);
         return true;
     }
 };
@@ -68,8 +86,13 @@ template<RuleType R>
 template<RuleType R>
 struct Plus {
     QCPC_DETAIL_DEFINE_PARSE(Plus) {
-        if (!R::parse(in, out, mem)) return false;
-        while (R::parse(in, out, mem)) {}
+        if (!R::parse(in, out, st)) return false;
+        auto floor = st.begin_choice(in.current());
+        while (R::parse(in, out, st)) {
+            st.end_choice(floor);
+            (void)st.begin_choice(in.current());
+        }
+        st.end_choice(floor);
         return true;
     }
 };
@@ -85,7 +108,7 @@ struct Seq {
     QCPC_DETAIL_DEFINE_PARSE(Seq) {
         auto pos = in.pos();
         size_t size = out.size();
-        if ((Rs::parse(in, out, mem) && ...)) return true;
+        if ((Rs::parse(in, out, st) && ...)) return true;
         in.jump(pos);
         out.erase(out.begin() + size, out.end());
         return false;
@@ -112,12 +135,52 @@ template<RuleType... R1s, RuleType... R2s>
     return {};
 }
 
+namespace detail {
+
+/// Order the alternatives of a `Sor` are tried in, see `profile.hpp`.
+template<class S>
+struct SorOrder;
+
+#ifdef QCPC_PROFILE
+/// Record that alternative `i` of `S` matched, see `profile.hpp`.
+template<class S>
+void sor_hit(size_t i) noexcept;
+#endif
+
+}  // namespace detail
+
 /// PEG ordered choice `e1 | e2`.
 template<RuleType... Rs>
 struct Sor {
     QCPC_DETAIL_DEFINE_PARSE(Sor) {
-        if ((Rs::parse(in, out, mem) || ...)) return true;
-        return false;
+        auto floor = st.begin_choice(in.current());
+        bool res = parse_alternatives(in, out, st, std::index_sequence_for<Rs...>{});
+        st.end_choice(floor);
+        return res;
+    }
+
+  private:
+    template<InputType Input, size_t... Is>
+    static bool parse_alternatives(Input& in,
+                                   Token::Children& out,
+                                   ::qcpc::detail::State& st,
+                                   std::index_sequence<Is...>) noexcept {
+        constexpr auto order = ::qcpc::detail::SorOrder<Sor>::value;
+        // A hard failure commits to the alternative which failed, see `must`.
+        bool res = false;
+        (((res = parse_alternative<order[Is]>(in, out, st)) || st.failed_hard()) || ...);
+        return res;
+    }
+
+    template<size_t I, InputType Input>
+    static bool parse_alternative(Input& in,
+                                  Token::Children& out,
+                                  ::qcpc::detail::State& st) noexcept {
+        bool res = std::tuple_element_t<I, std::tuple<Rs...>>::parse(in, out, st);
+#ifdef QCPC_PROFILE
+        if (res) ::qcpc::detail::sor_hit<Sor>(I);
+#endif
+        return res;
     }
 };
 
@@ -141,6 +204,25 @@ template<RuleType... R1s, RuleType... R2s>
     return {};
 }
 
+/// Match `R`, or fail the whole parse. Commits the choice it is in: `kw & must(rest)` never
+/// backtracks to try other alternatives once `kw` matched, and reports the error right there.
+/// Entering it also lets the memo drop entries no choice point can return to. A hard failure
+/// stops at the nearest enclosing `recover`.
+template<RuleType R>
+struct Must {
+    QCPC_DETAIL_DEFINE_PARSE(Must) {
+        st.commit(in.current());
+        if (R::parse(in, out, st)) return true;
+        st.fail_hard();
+        return false;
+    }
+};
+
+template<RuleType R>
+[[nodiscard]] constexpr Must<R> must(R) {
+    return {};
+}
+
 /// Equivalent to `R & *(S & R)`.
 template<RuleType R, RuleType S>
 [[nodiscard]] constexpr auto list(R r, S s) {
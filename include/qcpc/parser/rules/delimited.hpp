@@ -0,0 +1,209 @@
+#pragma once
+
+#include <bit>
+#include <cstring>
+#include <string_view>
+
+#include "../../input/simd.hpp"
+#include "ascii.hpp"
+#include "header.hpp"
+
+namespace qcpc {
+
+namespace detail {
+
+/// Return the first of `Cs` in `[p, end)`, or `end`. A single character is found with `memchr`,
+/// more are compared 16 at a time with SSE2. If `Padded`, 16 bytes past `end` are readable, and
+/// the last bytes are compared in one load too.
+template<bool Padded, char... Cs>
+[[nodiscard]] inline const char* find_first_of(const char* p, const char* end) noexcept {
+    if constexpr (sizeof...(Cs) == 1) {
+        constexpr char cs[] = {Cs...};
+        auto found = std::memchr(p, cs[0], end - p);
+        return found ? static_cast<const char*>(found) : end;
+    } else {
+#if QCPC_HAS_SSE2
+        while (Padded ? p < end : end - p >= 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i hits = _mm_setzero_si128();
+            ((hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(Cs)))), ...);
+            if (int mask = _mm_movemask_epi8(hits)) {
+                p += std::countr_zero(static_cast<unsigned>(mask));
+                return Padded && p > end ? end : p;
+            }
+            p += 16;
+        }
+        if constexpr (Padded) return end;
+#endif
+        while (p != end && ((*p != Cs) && ...)) ++p;
+        return p;
+    }
+}
+
+/// Return the first character in `[p, end)` that is none of `Cs`, or `end`. Characters are
+/// classified 16 at a time with SSE2.
+template<char... Cs>
+[[nodiscard]] inline const char* skip_any(const char* p, const char* end) noexcept {
+#if QCPC_HAS_SSE2
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hits = _mm_setzero_si128();
+        ((hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(Cs)))), ...);
+        if (int mask = _mm_movemask_epi8(hits) ^ 0xffff)
+            return p + std::countr_zero(static_cast<unsigned>(mask));
+        p += 16;
+    }
+#endif
+    while (p != end && ((*p == Cs) || ...)) ++p;
+    return p;
+}
+
+}  // namespace detail
+
+/// Match and consume a string delimited by `Open` and `Close`, where `Escape` followed by any
+/// character, e.g. `\"`, does not end it.
+/// `quoted<'"', '"', '\\'>` means `'"' ('\\' . / !'"' .)* '"'` in PEG.
+///
+/// The closing and escape characters are searched in bulk, and lines are counted once for the
+/// whole string. An unterminated string fails expecting `Close` at the end of input.
+template<char Open, char Close, char... Escape>
+struct Quoted {
+    static_assert(sizeof...(Escape) <= 1, "at most one escape character");
+    static_assert(((Escape != Close) && ...), "the escape character must differ from Close");
+
+    QCPC_DETAIL_DEFINE_PARSE(Quoted) {
+        if (in.is_eoi() || *in != Open) {
+            st.expect(in.current(), One<Open>::expected);
+            return false;
+        }
+        if constexpr (Input::is_segmented) {
+            return parse_segments(in, st);
+        } else {
+            const char* p = in.current() + 1;
+            const char* end = in.end();
+            while (true) {
+                p = detail::find_first_of<(Input::padding >= 16), Close, Escape...>(p, end);
+                if (p != end && *p == Close) break;
+                if (end - p < 2) {
+                    st.expect(end, One<Close>::expected);
+                    return false;
+                }
+                p += 2;
+            }
+            in.advance_to(p + 1);
+            return true;
+        }
+    }
+
+  private:
+    /// Search segment by segment, where an escape may be the last character of one.
+    template<InputType Input>
+    static bool parse_segments(Input& in, ::qcpc::detail::State& st) noexcept {
+        auto pos = in.pos();
+        ++in;
+        while (true) {
+            const char* p = in.current();
+            const char* end = in.end();
+            bool escaped = false;
+            while ((p = detail::find_first_of<false, Close, Escape...>(p, end)) != end) {
+                if (*p == Close) {
+                    in.advance_to(p + 1);
+                    return true;
+                }
+                if (end - p < 2) {
+                    escaped = true;
+                    p = end;
+                    break;
+                }
+                p += 2;
+            }
+            in.advance_to(end);
+            if (escaped && !in.is_eoi()) ++in;
+            if (in.is_eoi()) {
+                st.expect(in.current(), One<Close>::expected);
+                in.jump(pos);
+                return false;
+            }
+        }
+    }
+};
+
+template<char Open, char Close, char... Escape>
+inline constexpr Quoted<Open, Close, Escape...> quoted{};
+
+/// Match and consume input up to and including `S`, e.g. the rest of a block comment.
+/// `until<"*/">` means `(!"*/" .)* "*/"` in PEG.
+///
+/// `S` is searched with `memchr` on its first character. If it is not found, fail expecting `S`
+/// at the end of input.
+template<detail::FixedString S>
+struct Until {
+    static_assert(S.size() > 0, "empty terminator");
+
+    QCPC_DETAIL_DEFINE_PARSE(Until) {
+        if constexpr (Input::is_segmented) {
+            return parse_segments(in, st);
+        } else {
+            std::string_view rest(in.current(), in.size());
+            size_t found = rest.find(std::string_view(S.data, S.size()));
+            if (found == std::string_view::npos) {
+                st.expect(in.end(), Str<S>::expected);
+                return false;
+            }
+            in.advance_to(in.current() + found + S.size());
+            return true;
+        }
+    }
+
+  private:
+    /// Search the first character of `S` segment by segment, and compare the rest with `S`, which
+    /// may cross segments.
+    template<InputType Input>
+    static bool parse_segments(Input& in, ::qcpc::detail::State& st) noexcept {
+        auto pos = in.pos();
+        while (true) {
+            const char* end = in.end();
+            auto found = std::memchr(in.current(), S[0], end - in.current());
+            in.advance_to(found ? static_cast<const char*>(found) : end);
+            if (in.is_eoi()) break;
+            if (!found) continue;
+            const char* p = in.contiguous(S.size());
+            if (!p) break;
+            if (std::memcmp(p, S.data, S.size()) == 0) {
+                in.advance(S.size());
+                return true;
+            }
+            ++in;
+        }
+        while (!in.is_eoi()) in.advance_to(in.end());
+        st.expect(in.current(), Str<S>::expected);
+        in.jump(pos);
+        return false;
+    }
+};
+
+template<detail::FixedString S>
+inline constexpr Until<S> until{};
+
+/// Match and consume input up to but excluding any of `Cs`, or up to the end of input. It may
+/// match empty input.
+/// `until_any(one<'\n', ';'>)` means `(![\n;] .)*` in PEG.
+template<char... Cs>
+struct UntilAny {
+    QCPC_DETAIL_DEFINE_PARSE(UntilAny) {
+        // Segmented inputs continue in the next segment if none is found in the current one.
+        while (true) {
+            const char* end = in.end();
+            const char* p = detail::find_first_of<(Input::padding >= 16), Cs...>(in.current(), end);
+            in.advance_to(p);
+            if (p != end || in.is_eoi()) return true;
+        }
+    }
+};
+
+template<char... Cs>
+[[nodiscard]] constexpr UntilAny<Cs...> until_any(One<Cs...>) {
+    return {};
+}
+
+}  // namespace qcpc
@@ -1,13 +1,12 @@
 #pragma once
 
 #include <concepts>
-#include <functional>
-#include <tuple>
+#include <string_view>
 #include <type_traits>
-#include <unordered_map>
 
 #include "../../input/input.hpp"
 #include "../rule_tag.hpp"
+#include "../state.hpp"
 #include "../token.hpp"
 
 namespace qcpc {
@@ -19,42 +18,98 @@ static_assert(true);  // fuck clang-format
 
 namespace detail {
 
-using MemKey = std::tuple<const char*, RuleTag>;
+/// A string literal usable as a non-type template parameter.
+template<size_t N>
+struct FixedString {
+    char data[N + 1]{};
 
-struct MemKeyHash {
-    size_t operator()(MemKey key) const noexcept {
-        auto [pos, rule] = key;
-        auto h1 = std::hash<decltype(pos)>{}(pos);
-        auto h2 = std::hash<decltype(rule)>{}(rule);
-        return h1 ^ (h2 << 1);
+    constexpr FixedString(const char (&str)[N + 1]) noexcept {
+        for (size_t i = 0; i < N; ++i) this->data[i] = str[i];
+    }
+
+    [[nodiscard]] constexpr size_t size() const noexcept {
+        return N;
+    }
+
+    [[nodiscard]] constexpr char operator[](size_t i) const noexcept {
+        return this->data[i];
+    }
+};
+
+template<size_t N>
+FixedString(const char (&)[N]) -> FixedString<N - 1>;
+
+/// What a terminal rule expects in PEG notation, e.g. `'a'`, `"abc"` or `[0-9]`, built at compile
+/// time. `N` is the capacity.
+template<size_t N>
+struct Description {
+    char data[N]{};
+    size_t size = 0;
+
+    constexpr void push(char c) noexcept {
+        this->data[this->size++] = c;
+    }
+
+    /// Push `c`, escaping it if it is not printable or is one of `specials`.
+    constexpr void push_escaped(char c, std::string_view specials) noexcept {
+        constexpr char digits[] = "0123456789abcdef";
+        switch (c) {
+        case '\n': this->push('\\'), this->push('n'); return;
+        case '\r': this->push('\\'), this->push('r'); return;
+        case '\t': this->push('\\'), this->push('t'); return;
+        default: break;
+        }
+        auto u = static_cast<unsigned char>(c);
+        if (u < 0x20 || u >= 0x7f) {
+            this->push('\\');
+            this->push('x');
+            this->push(digits[u >> 4]);
+            this->push(digits[u & 15]);
+            return;
+        }
+        if (c == '\\' || specials.find(c) != std::string_view::npos) this->push('\\');
+        this->push(c);
+    }
+
+    [[nodiscard]] constexpr operator std::string_view() const noexcept {
+        return {this->data, this->size};
     }
 };
 
-using MemMap = std::unordered_map<MemKey, InputPos, MemKeyHash>;
+/// Each instantiation has a distinct address, which identifies `T` at runtime without hashing
+/// its name at compile time like `rule_tag<T>()` does.
+template<class T>
+inline constexpr char type_anchor = 0;
 
 }  // namespace detail
 
-#define QCPC_DETAIL_DEFINE_PARSE(rule_name)                                            \
-    /* Packrat parsing */                                                              \
-    template<InputType Input>                                                          \
-    static bool parse(Input& in, Token::Children& out, detail::MemMap& mem) noexcept { \
-        detail::MemKey key{in.current(), detail::rule_tag<rule_name>()};             \
-        if (mem.contains(key)) {                                                       \
-            in.jump(mem[key]);                                                         \
-            return true;                                                               \
-        } else {                                                                       \
-            auto pos = in.pos();                                                       \
-            bool res = parse_detail(in, out, mem);                                     \
-            if (res) mem[key] = pos;                                                   \
-            return res;                                                                \
-        }                                                                              \
-    }                                                                                  \
-                                                                                       \
-    template<InputType Input>                                                          \
-    static bool parse_detail(Input& in,                                                \
-                             [[maybe_unused]] Token::Children& out,                    \
-                             [[maybe_unused]] detail::MemMap& mem) noexcept
-
-// TODO: do we need `State&&` here?
+// Packrat parsing. Only successes without tokens are memoized, since a hit restores the end
+// position but can not replay tokens.
+//
+// Terminal rules declare `expected`, a description reported when they fail at the farthest
+// position.
+#define QCPC_DETAIL_DEFINE_PARSE(rule_name)                                                  \
+    template<InputType Input>                                                                \
+    static bool parse(Input& in, Token::Children& out, ::qcpc::detail::State& st) noexcept { \
+        ::qcpc::detail::MemKey key{in.current(), &::qcpc::detail::type_anchor<rule_name>};   \
+        if (auto it = st.mem.find(key); it != st.mem.end()) {                                \
+            in.jump(it->second);                                                             \
+            return true;                                                                     \
+        } else {                                                                             \
+            size_t size = out.size();                                                        \
+            bool res = parse_detail(in, out, st);                                            \
+            if (res && out.size() == size) st.mem.emplace(key, in.pos());                    \
+            if constexpr (requires { std::string_view(rule_name::expected); }) {             \
+                /* Terminals fail without consuming. */                                      \
+                if (!res) st.expect(in.current(), rule_name::expected);                      \
+            }                                                                                \
+            return res;                                                                      \
+        }                                                                                    \
+    }                                                                                        \
+                                                                                             \
+    template<InputType Input>                                                                \
+    static bool parse_detail(Input& in,                                                      \
+                             [[maybe_unused]] Token::Children& out,                          \
+                             [[maybe_unused]] ::qcpc::detail::State& st) noexcept
 
 }  // namespace qcpc
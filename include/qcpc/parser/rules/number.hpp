@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+#include "header.hpp"
+
+namespace qcpc {
+
+namespace detail {
+
+/// Return a mask with the high bit set in each byte of `chunk` that is not an ASCII digit.
+[[nodiscard]] constexpr uint64_t non_digits(uint64_t chunk) noexcept {
+    constexpr uint64_t ones = 0x0101010101010101;
+    // Digits become 0 to 9, adding 0x76 carries anything greater into the high bit.
+    uint64_t t = chunk ^ (ones * 0x30);
+    return (((t & (ones * 0x7f)) + ones * 0x76) | t) & (ones * 0x80);
+}
+
+/// Skip ASCII digits from `p`, 8 at a time. If `Padded`, 8 zero bytes past `end` are readable,
+/// which stop the scan like any non-digit.
+template<bool Padded = false>
+[[nodiscard]] inline const char* skip_digits(const char* p, const char* end) noexcept {
+    if constexpr (std::endian::native == std::endian::little) {
+        while (Padded || end - p >= 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, p, 8);
+            uint64_t mask = non_digits(chunk);
+            if (mask != 0) return p + std::countr_zero(mask) / 8;
+            p += 8;
+        }
+    }
+    while (p != end && static_cast<unsigned char>(*p - '0') < 10) ++p;
+    return p;
+}
+
+/// Return the value of the ASCII digits in `[p, end)`, modulo 2^64. Eight digits are combined
+/// with three multiplications instead of eight.
+[[nodiscard]] inline uint64_t parse_digits(const char* p, const char* end) noexcept {
+    uint64_t ret = 0;
+    if constexpr (std::endian::native == std::endian::little) {
+        while (end - p >= 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, p, 8);
+            chunk -= 0x3030303030303030;
+            chunk = chunk * 10 + (chunk >> 8);
+            chunk = ((chunk & 0x000000ff000000ff) * (100 + (1000000ull << 32)) +
+                     ((chunk >> 16) & 0x000000ff000000ff) * (1 + (10000ull << 32))) >>
+                    32;
+            ret = ret * 100000000 + chunk;
+            p += 8;
+        }
+    }
+    for (; p != end; ++p) ret = ret * 10 + (*p - '0');
+    return ret;
+}
+
+[[nodiscard]] constexpr int hex_digit(char c) noexcept {
+    if ('0' <= c && c <= '9') return c - '0';
+    if ('a' <= c && c <= 'f') return c - 'a' + 10;
+    if ('A' <= c && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+[[nodiscard]] constexpr bool is_number_char(char c) noexcept {
+    return hex_digit(c) >= 0 || c == '.' || c == '+' || c == '-' || c == 'e' || c == 'E';
+}
+
+/// Return the contiguous characters from the current position that numeric rules scan. For
+/// segmented inputs, characters a number may consist of are copied into one buffer if they cross
+/// segments.
+template<class Input>
+[[nodiscard]] std::string_view number_window(const Input& in) noexcept {
+    std::string_view chunk(in.current(), in.end() - in.current());
+    if constexpr (Input::is_segmented) {
+        size_t n = 0;
+        while (n < chunk.size() && is_number_char(chunk[n])) ++n;
+        if (n < chunk.size()) return chunk;
+        for (size_t size = in.size(); n < size && is_number_char(in[n]);) ++n;
+        return {in.contiguous(n), n};
+    } else {
+        return chunk;
+    }
+}
+
+/// Match a decimal integer that fits in `T` from `p`, see `Integer`. Return the end of the match
+/// and set `value`, or return null.
+template<std::integral T, bool Padded>
+[[nodiscard]] const char* match_integer(const char* p, const char* end, T& value) noexcept {
+    bool negative = false;
+    if constexpr (std::is_signed_v<T>) {
+        negative = p != end && *p == '-';
+        p += negative;
+    }
+    const char* digits = p;
+    p = skip_digits<Padded>(p, end);
+    if (p == digits) return nullptr;
+
+    // Leading zeros aside, 19 digits always fit in `uint64_t`, and more than 20 never do.
+    const char* first = digits;
+    while (first + 1 != p && *first == '0') ++first;
+    if (p - first > std::numeric_limits<uint64_t>::digits10 + 1) return nullptr;
+    uint64_t magnitude = parse_digits(first, p - 1);
+    auto last = static_cast<uint64_t>(p[-1] - '0');
+    if (magnitude > (std::numeric_limits<uint64_t>::max() - last) / 10) return nullptr;
+    magnitude = magnitude * 10 + last;
+    auto limit = static_cast<uint64_t>(std::numeric_limits<T>::max());
+    if (magnitude > limit + negative) return nullptr;
+    value = static_cast<T>(negative ? 0 - magnitude : magnitude);
+    return p;
+}
+
+/// Match hexadecimal digits of a 64-bit integer from `p`, see `Hex`. Return the end of the match
+/// and set `value`, or return null.
+[[nodiscard]] inline const char* match_hex(const char* p,
+                                           const char* end,
+                                           uint64_t& value) noexcept {
+    const char* begin = p;
+    const char* first = nullptr;
+    uint64_t ret = 0;
+    for (int digit; p != end && (digit = hex_digit(*p)) >= 0; ++p) {
+        if (!first && digit != 0) first = p;
+        ret = ret << 4 | static_cast<uint64_t>(digit);
+    }
+    if (p == begin || (first && p - first > 16)) return nullptr;
+    value = ret;
+    return p;
+}
+
+/// Match a decimal floating-point number from `p`, see `Floating`. Return the end of the match,
+/// or null.
+template<bool Padded>
+[[nodiscard]] const char* match_floating(const char* p, const char* end) noexcept {
+    p += p != end && *p == '-';
+    const char* digits = p;
+    p = skip_digits<Padded>(p, end);
+    if (p == digits) return nullptr;
+    if (end - p >= 2 && *p == '.' && static_cast<unsigned char>(p[1] - '0') < 10)
+        p = skip_digits<Padded>(p + 2, end);
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        q += q != end && (*q == '+' || *q == '-');
+        const char* exponent = skip_digits<Padded>(q, end);
+        if (exponent != q) p = exponent;
+    }
+    return p;
+}
+
+}  // namespace detail
+
+/// Match and consume a decimal integer that fits in `T`, with a leading `-` if `T` is signed.
+/// `integer<int>` means `'-'? [0-9]+` in PEG, failing on overflow.
+///
+/// Digits are scanned 8 at a time, and converted to the value as they are checked for overflow.
+template<std::integral T>
+struct Integer {
+    QCPC_DETAIL_DEFINE_PARSE(Integer) {
+        std::string_view window = detail::number_window(in);
+        T value;
+        const char* p = detail::match_integer<T, (Input::padding >= 8)>(
+            window.data(), window.data() + window.size(), value);
+        if (!p) return false;
+        in.advance(p - window.data());
+        return true;
+    }
+
+    /// Return the value of `str` if it is a match as a whole, e.g.
+    /// `*integer<int>.value(token.view())` of a token matched by it.
+    [[nodiscard]] static std::optional<T> value(std::string_view str) noexcept {
+        T ret;
+        const char* end = str.data() + str.size();
+        const char* p = detail::match_integer<T, false>(str.data(), end, ret);
+        if (!p || p != end) return std::nullopt;
+        return ret;
+    }
+
+    constexpr static std::string_view expected = "integer";
+};
+
+template<std::integral T>
+inline constexpr Integer<T> integer{};
+
+/// Match and consume an unsigned decimal integer of 64 bits.
+inline constexpr Integer<uint64_t> decimal{};
+
+/// Match and consume hexadecimal digits of an unsigned integer of 64 bits, without a prefix.
+/// `hex` means `[0-9a-fA-F]+` in PEG, failing on overflow. Combine it like
+/// `QCPC_STR("0x") & hex` for prefixed literals.
+struct Hex {
+    QCPC_DETAIL_DEFINE_PARSE(Hex) {
+        std::string_view window = detail::number_window(in);
+        uint64_t value;
+        const char* p = detail::match_hex(window.data(), window.data() + window.size(), value);
+        if (!p) return false;
+        in.advance(p - window.data());
+        return true;
+    }
+
+    /// Return the value of `str` if it is a match as a whole.
+    [[nodiscard]] static std::optional<uint64_t> value(std::string_view str) noexcept {
+        uint64_t ret;
+        const char* end = str.data() + str.size();
+        const char* p = detail::match_hex(str.data(), end, ret);
+        if (!p || p != end) return std::nullopt;
+        return ret;
+    }
+
+    constexpr static std::string_view expected = "hexadecimal integer";
+};
+
+inline constexpr Hex hex{};
+
+/// Match and consume a decimal floating-point number.
+/// `floating` means `'-'? [0-9]+ ('.' [0-9]+)? ([eE] [+-]? [0-9]+)?` in PEG.
+///
+/// `value` converts a match with `std::from_chars`, which is exact. Values beyond the range of
+/// `double` give infinities, and ones too close to zero give zeros.
+struct Floating {
+    QCPC_DETAIL_DEFINE_PARSE(Floating) {
+        std::string_view window = detail::number_window(in);
+        const char* p = detail::match_floating<(Input::padding >= 8)>(
+            window.data(), window.data() + window.size());
+        if (!p) return false;
+        in.advance(p - window.data());
+        return true;
+    }
+
+    /// Return the value of `str` if it is a match as a whole.
+    [[nodiscard]] static std::optional<double> value(std::string_view str) noexcept {
+        const char* end = str.data() + str.size();
+        const char* p = detail::match_floating<false>(str.data(), end);
+        if (!p || p != end) return std::nullopt;
+        double ret = 0;
+        auto [ptr, ec] = std::from_chars(str.data(), end, ret);
+        if (ec == std::errc::result_out_of_range) {
+            ret = overflows(str) ? std::numeric_limits<double>::infinity() : 0.0;
+            if (str[0] == '-') ret = -ret;
+        }
+        return ret;
+    }
+
+    constexpr static std::string_view expected = "number";
+
+  private:
+    /// Return whether an out-of-range match is too large rather than too small, from where its
+    /// first significant digit is.
+    [[nodiscard]] static bool overflows(std::string_view str) noexcept {
+        size_t first = str.find_first_of("123456789");
+        size_t exp = str.find_first_of("eE");
+        size_t point = std::min(std::min(str.find('.'), exp), str.size());
+        // The decimal exponent of the first significant digit, plus one.
+        int64_t scale = first < point ? int64_t(point - first) : -int64_t(first - point - 1);
+        if (exp != std::string_view::npos) {
+            bool negative = str[exp + 1] == '-';
+            int64_t e = 0;
+            for (size_t i = exp + 1 + (negative || str[exp + 1] == '+'); i < str.size(); ++i)
+                e = std::min<int64_t>(e * 10 + (str[i] - '0'), 1 << 20);
+            scale += negative ? -e : e;
+        }
+        return scale > 0;
+    }
+};
+
+inline constexpr Floating floating{};
+
+}  // namespace qcpc
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "../rule_tag.hpp"
+#include "combinator.hpp"
+#include "recovery.hpp"
+
+#ifdef QCPC_PROFILE
+    #include <atomic>
+    #include <cstdio>
+    #include <vector>
+#endif
+
+// Profile-guided ordering of choices. Alternatives of a `Sor` which begin with different
+// characters can not both match at the same position, so trying them in any order gives the same
+// result, and trying the most frequent match first is the fastest. A build with `QCPC_PROFILE`
+// defined counts the matches of every alternative, and `profile::save` writes them as a header
+// which, included before any qcpc header, reorders those choices at compile time. Builds without
+// a profile do not look profiles up, so their choices cost no type hashing.
+
+namespace qcpc {
+
+namespace detail {
+
+/// Maximum number of alternatives of a profiled `Sor`.
+inline constexpr size_t MAX_PROFILED_ALTERNATIVES = 64;
+
+/// How often each alternative of a `Sor` matched, in the order they are written.
+struct SorHits {
+    size_t size = 0;
+    uint64_t hits[MAX_PROFILED_ALTERNATIVES]{};
+};
+
+/// Hits of the `Sor` whose `rule_tag` is `Id`, specialized by headers written by `profile::save`.
+template<RuleTag Id>
+inline constexpr SorHits sor_profile{};
+
+/// Return whether at most one of `Rs` can match at any position, since none of them matches
+/// empty input and no two begin with the same character.
+template<class... Rs>
+consteval bool disjoint() {
+    if constexpr (!(FirstChars<Rs>::known && ...)) {
+        return false;
+    } else {
+        for (size_t c = 0; c < 256; ++c) {
+            if ((size_t(FirstChars<Rs>::chars[c]) + ...) > 1) return false;
+        }
+        return true;
+    }
+}
+
+#if defined(QCPC_PROFILE) || defined(QCPC_PROFILE_DATA)
+    // Tells profile headers they are read, see `profile::save`.
+    #define QCPC_DETAIL_PROFILE_DATA
+
+template<class... Rs>
+struct SorOrder<Sor<Rs...>> {
+    constexpr static const SorHits& profile = sor_profile<rule_tag<Sor<Rs...>>()>;
+
+    constexpr static std::array<size_t, sizeof...(Rs)> value = [] {
+        std::array<size_t, sizeof...(Rs)> ret{};
+        for (size_t i = 0; i < ret.size(); ++i) ret[i] = i;
+        if constexpr (profile.size != 0) {
+            static_assert(profile.size == sizeof...(Rs) && disjoint<Rs...>(),
+                          "only choices of disjoint alternatives can be reordered");
+            std::sort(ret.begin(), ret.end(), [](size_t a, size_t b) {
+                if (profile.hits[a] != profile.hits[b]) return profile.hits[a] > profile.hits[b];
+                return a < b;
+            });
+        }
+        return ret;
+    }();
+};
+#else
+// Without profiles, choices keep their order, and their types are not hashed by `rule_tag`.
+template<class... Rs>
+struct SorOrder<Sor<Rs...>> {
+    constexpr static std::array<size_t, sizeof...(Rs)> value = [] {
+        std::array<size_t, sizeof...(Rs)> ret{};
+        for (size_t i = 0; i < ret.size(); ++i) ret[i] = i;
+        return ret;
+    }();
+};
+#endif
+
+#ifdef QCPC_PROFILE
+/// Match counts of a `Sor` seen by a profiling run.
+struct SorCounters {
+    RuleTag id;
+    bool disjoint;
+    size_t size;
+    std::atomic<uint64_t>* hits;
+    SorCounters* next;
+};
+
+/// All `Sor`s seen so far, most recent first.
+inline std::atomic<SorCounters*> profiled_sors{nullptr};
+
+template<class S>
+struct SorCounter;
+
+template<class... Rs>
+struct SorCounter<Sor<Rs...>> {
+    static void hit(size_t i) noexcept {
+        static std::atomic<uint64_t> hits[sizeof...(Rs)]{};
+        static SorCounters counters{
+            rule_tag<Sor<Rs...>>(), disjoint<Rs...>(), sizeof...(Rs), hits, nullptr};
+        static bool added = [] {
+            counters.next = profiled_sors.load();
+            while (!profiled_sors.compare_exchange_weak(counters.next, &counters)) {}
+            return true;
+        }();
+        (void)added;
+        hits[i].fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+template<class S>
+void sor_hit(size_t i) noexcept {
+    SorCounter<S>::hit(i);
+}
+#endif
+
+}  // namespace detail
+
+#ifdef QCPC_PROFILE
+namespace profile {
+
+/// Write the match counts of choices which can be reordered as a header for `QCPC_PROFILE`-less
+/// builds, see above. Return whether it is written. Ids are hashes of type names, so a profile
+/// only applies to builds with the same compiler and rule names.
+[[nodiscard]] inline bool save(const char* path) {
+    std::vector<const detail::SorCounters*> sors;
+    for (auto* p = detail::profiled_sors.load(); p; p = p->next) {
+        if (p->disjoint && p->size <= detail::MAX_PROFILED_ALTERNATIVES) sors.push_back(p);
+    }
+    std::sort(sors.begin(), sors.end(), [](auto* a, auto* b) { return a->id < b->id; });
+
+    std::FILE* file = std::fopen(path, "w");
+    if (!file) return false;
+    std::fputs("// Generated by qcpc::profile::save.\n#pragma once\n\n", file);
+    std::fputs("#ifndef QCPC_PROFILE_DATA\n    #define QCPC_PROFILE_DATA\n#endif\n", file);
+    std::fputs("#include \"qcpc/qcpc.hpp\"\n\n", file);
+    std::fputs("#ifndef QCPC_DETAIL_PROFILE_DATA\n", file);
+    std::fputs("    #error \"Include profiles before any qcpc header.\"\n#endif\n\n", file);
+    std::fputs("namespace qcpc::detail {\n", file);
+    for (const auto* sor: sors) {
+        std::fputs("\ntemplate<>\ninline constexpr SorHits ", file);
+        std::fprintf(file,
+                     "sor_profile<0x%016llxull> =\n    {%zu, {",
+                     static_cast<unsigned long long>(sor->id),
+                     sor->size);
+        for (size_t i = 0; i < sor->size; ++i) {
+            std::fprintf(file,
+                         "%s%llu",
+                         i == 0 ? "" : ", ",
+                         static_cast<unsigned long long>(sor->hits[i].load()));
+        }
+        std::fputs("}};\n", file);
+    }
+    std::fputs("\n}  // namespace qcpc::detail\n", file);
+    bool ok = !std::ferror(file);
+    return std::fclose(file) == 0 && ok;
+}
+
+}  // namespace profile
+#endif
+
+}  // namespace qcpc
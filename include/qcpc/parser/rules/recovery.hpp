@@ -0,0 +1,256 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstring>
+
+#include "../../input/simd.hpp"
+#include "ascii.hpp"
+#include "combinator.hpp"
+#include "delimited.hpp"
+#include "header.hpp"
+#include "number.hpp"
+#include "zero_width.hpp"
+
+namespace qcpc {
+
+namespace detail {
+
+using CharTable = std::array<bool, 256>;
+
+/// Characters a match of `R` can begin with, used to skip input without trying `R` at every
+/// position. `known` is false if they can not be told from the type.
+template<class R>
+struct FirstChars {
+    constexpr static bool known = false;
+};
+
+template<char... Cs>
+struct FirstChars<One<Cs...>> {
+    constexpr static bool known = true;
+    constexpr static CharTable chars = [] {
+        CharTable ret{};
+        ((ret[static_cast<unsigned char>(Cs)] = true), ...);
+        return ret;
+    }();
+};
+
+// The empty string matches empty input, so any character may follow.
+template<FixedString S>
+struct FirstChars<Str<S>> {
+    constexpr static bool known = S.size() > 0;
+    constexpr static CharTable chars = [] {
+        CharTable ret{};
+        if constexpr (known) ret[static_cast<unsigned char>(S[0])] = true;
+        return ret;
+    }();
+};
+
+template<char... Cs>
+struct FirstChars<Range<Cs...>> {
+    constexpr static bool known = true;
+    constexpr static CharTable chars = [] {
+        constexpr unsigned char cs[] = {static_cast<unsigned char>(Cs)...};
+        constexpr size_t size = sizeof...(Cs);
+        CharTable ret{};
+        for (size_t i = 0; i + 1 < size; i += 2) {
+            for (size_t c = cs[i]; c <= cs[i + 1]; ++c) ret[c] = true;
+        }
+        if constexpr (size % 2 == 1) ret[cs[size - 1]] = true;
+        return ret;
+    }();
+};
+
+template<>
+struct FirstChars<Eol> {
+    constexpr static bool known = true;
+    constexpr static CharTable chars = [] {
+        CharTable ret{};
+        ret['\n'] = ret['\r'] = true;
+        return ret;
+    }();
+};
+
+template<char Open, char Close, char... Escape>
+struct FirstChars<Quoted<Open, Close, Escape...>>: FirstChars<One<Open>> {};
+
+template<std::integral T>
+struct FirstChars<Integer<T>> {
+    constexpr static bool known = true;
+    constexpr static CharTable chars = [] {
+        CharTable ret{};
+        for (size_t c = '0'; c <= '9'; ++c) ret[c] = true;
+        ret['-'] = std::is_signed_v<T>;
+        return ret;
+    }();
+};
+
+template<>
+struct FirstChars<Hex>: FirstChars<Range<'0', '9', 'a', 'f', 'A', 'F'>> {};
+
+template<>
+struct FirstChars<Floating>: FirstChars<Range<'0', '9', '-'>> {};
+
+template<class R>
+struct FirstChars<Plus<R>>: FirstChars<R> {};
+
+// None of the known rules matches empty input, so the first one decides.
+template<class R, class... Rs>
+struct FirstChars<Seq<R, Rs...>>: FirstChars<R> {};
+
+// An optional first rule may match empty input, so the rest may begin the match as well.
+template<class R, class R2, class... Rs>
+struct FirstChars<Seq<Opt<R>, R2, Rs...>> {
+    constexpr static bool known = FirstChars<R>::known && FirstChars<Seq<R2, Rs...>>::known;
+    constexpr static CharTable chars = [] {
+        CharTable ret{};
+        if constexpr (known) {
+            for (size_t c = 0; c < 256; ++c)
+                ret[c] = FirstChars<R>::chars[c] || FirstChars<Seq<R2, Rs...>>::chars[c];
+        }
+        return ret;
+    }();
+};
+
+template<class... Rs>
+struct FirstChars<Sor<Rs...>> {
+    constexpr static bool known = (FirstChars<Rs>::known && ...);
+    constexpr static CharTable chars = [] {
+        CharTable ret{};
+        if constexpr (known) {
+            for (size_t c = 0; c < 256; ++c) ret[c] = (FirstChars<Rs>::chars[c] || ...);
+        }
+        return ret;
+    }();
+};
+
+/// Return the characters in `chars`, in order.
+consteval auto char_list(const CharTable& chars) {
+    struct {
+        std::array<char, 256> data{};
+        size_t size = 0;
+    } ret;
+    for (size_t c = 0; c < 256; ++c) {
+        if (chars[c]) ret.data[ret.size++] = static_cast<char>(c);
+    }
+    return ret;
+}
+
+/// Return the first position in `[p, end)` a match of `R` may begin at, or `end`. A single
+/// character is found with `memchr`, up to 8 are compared 16 at a time with SSE2, and more are
+/// looked up in the table.
+template<class R>
+    requires FirstChars<R>::known
+[[nodiscard]] inline const char* next_candidate(const char* p, const char* end) noexcept {
+    constexpr const CharTable& chars = FirstChars<R>::chars;
+    constexpr auto list = char_list(chars);
+    if constexpr (list.size == 1) {
+        auto found = std::memchr(p, list.data[0], end - p);
+        return found ? static_cast<const char*>(found) : end;
+    } else {
+#if QCPC_HAS_SSE2
+        if constexpr (list.size <= 8) {
+            while (end - p >= 16) {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i hits = _mm_setzero_si128();
+                for (size_t i = 0; i < list.size; ++i)
+                    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(list.data[i])));
+                if (int mask = _mm_movemask_epi8(hits))
+                    return p + std::countr_zero(static_cast<unsigned>(mask));
+                p += 16;
+            }
+        }
+#endif
+        while (p != end && !chars[static_cast<unsigned char>(*p)]) ++p;
+        return p;
+    }
+}
+
+/// Skip input until `S` matches or the end of input, without consuming `S`.
+template<RuleType S, InputType Input>
+void skip_until(Input& in, State& st) noexcept {
+    Token::Children scratch(st.resource());
+    st.begin_quiet();
+    while (!in.is_eoi() && st.reason() == AbortReason::None) {
+        if constexpr (FirstChars<S>::known) {
+            // Jump to the next candidate instead of trying `S` everywhere.
+            in.advance_to(next_candidate<S>(in.current(), in.end()));
+            if (in.is_eoi()) break;
+        }
+        auto pos = in.pos();
+        bool found = S::parse(in, scratch, st);
+        in.jump(pos);
+        scratch.clear();
+        if (found) break;
+        ++in;
+    }
+    st.end_quiet();
+}
+
+}  // namespace detail
+
+/// Match `R`. If it fails, skip input until `S` matches, without consuming `S`, and produce an
+/// error token tagged `ERROR_RULE` spanning the skipped input instead. What `R` expected is
+/// added to the diagnostics of the parse.
+///
+/// A hard failure of `must` inside `R` is recovered too.
+///
+/// At least one character is skipped so that loops over `recover` make progress, hence it fails
+/// only if `R` fails at the end of input. Sync rules made of characters, strings and ranges, like
+/// `one<'\n'>` or `QCPC_STR("};")`, are searched with `memchr` or a table lookup instead of being
+/// tried at every position.
+template<RuleType R, RuleType S>
+struct Recover {
+    QCPC_DETAIL_DEFINE_PARSE(Recover) {
+        // A hard failure from before is not ours to recover.
+        if (st.failed_hard()) return false;
+        auto pos = in.pos();
+        size_t size = out.size();
+        auto saved = st.begin_recoverable(pos.current);
+        auto floor = st.begin_choice(pos.current);
+        // `R` may still match after a hard failure inside, e.g. of a repetition, but fails.
+        bool res = R::parse(in, out, st) && !st.failed_hard();
+        st.end_choice(floor);
+        if (res) {
+            st.end_recoverable(saved);
+            return true;
+        }
+        if (st.reason() != AbortReason::None) return false;
+        in.jump(pos);
+        out.erase(out.begin() + size, out.end());
+        if (in.is_eoi()) return false;
+        st.clear_hard_failure();
+
+        ++in;
+        detail::skip_until<S>(in, st);
+        out.push_back({Token::Children(st.resource()), {pos, in.current()}, ERROR_RULE});
+        st.recovered(pos.current, in.current());
+        return true;
+    }
+};
+
+template<RuleType R, RuleType S>
+[[nodiscard]] constexpr Recover<R, S> recover(R, S) {
+    return {};
+}
+
+/// Match `R`, reporting a failure as expecting `Name` instead of what `R` expected inside.
+/// `label<"statement">(r)` gives "expected statement" rather than a list of terminals.
+template<detail::FixedString Name, RuleType R>
+struct Label {
+    QCPC_DETAIL_DEFINE_PARSE(Label) {
+        st.begin_quiet();
+        bool res = R::parse(in, out, st);
+        st.end_quiet();
+        return res;
+    }
+
+    constexpr static std::string_view expected{Name.data, Name.size()};
+};
+
+template<detail::FixedString Name, RuleType R>
+[[nodiscard]] constexpr Label<Name, R> label(R) {
+    return {};
+}
+
+}  // namespace qcpc
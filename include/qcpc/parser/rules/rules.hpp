@@ -1,7 +1,13 @@
 #pragma once
 
 #include "ascii.hpp"
+#include "binary.hpp"
 #include "combinator.hpp"
+#include "delimited.hpp"
+#include "number.hpp"
+#include "profile.hpp"
+#include "recovery.hpp"
+#include "utf8.hpp"
 #include "zero_width.hpp"
 
 namespace qcpc {
@@ -19,10 +25,6 @@ inline constexpr auto ident = ident_first & *ident_other;
 template<char... Cs>
 inline constexpr auto keyword = str<Cs...> & !ident_other;
 
-#define QCPC_KEYWORD(s)                            \
-    []<size_t... Is>(std::index_sequence<Is...>) { \
-        return ::qcpc::keyword<(s)[Is]...>;        \
-    }                                              \
-    (std::make_index_sequence<sizeof(s) - 1>{})
+#define QCPC_KEYWORD(s) (::qcpc::detail::make_str<s>() & !::qcpc::ident_other)
 
 }  // namespace qcpc
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <array>
+
+#include "../../input/utf8.hpp"
+#include "ascii.hpp"
+#include "combinator.hpp"
+#include "header.hpp"
+#include "unicode_tables.hpp"
+
+namespace qcpc::utf8 {
+
+namespace detail {
+
+/// Decode the code point at the current position into `cp` and return its length, or return 0
+/// at the end of input or an invalid sequence. Inputs known to be valid skip the checks.
+template<InputType Input>
+[[nodiscard]] size_t peek(const Input& in, char32_t& cp) noexcept {
+    if (in.is_eoi()) return 0;
+    auto lead = static_cast<unsigned char>(*in);
+    if (lead < 0x80) {
+        cp = lead;
+        return 1;
+    }
+    if constexpr (Input::is_utf8) {
+        return decode_valid(in.current(), cp);
+    } else if constexpr (Input::is_segmented) {
+        // A sequence may cross segments.
+        size_t size = in.size() < 4 ? in.size() : 4;
+        const char* p = in.contiguous(size);
+        return decode(p, p + size, cp);
+    } else {
+        return decode(in.current(), in.end(), cp);
+    }
+}
+
+/// Return whether `cp` is in the sorted, disjoint `ranges`.
+template<size_t N>
+[[nodiscard]] constexpr bool in_ranges(const CodePointRange (&ranges)[N], char32_t cp) noexcept {
+    size_t lo = 0;
+    size_t hi = N;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (cp < ranges[mid].first) {
+            hi = mid;
+        } else if (cp > ranges[mid].last) {
+            lo = mid + 1;
+        } else {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// A table of ASCII characters in `ranges`, so that the common case is one lookup.
+template<size_t N>
+[[nodiscard]] consteval std::array<bool, 128> ascii_table(const CodePointRange (&ranges)[N]) {
+    std::array<bool, 128> ret{};
+    for (char32_t c = 0; c < 128; ++c) ret[c] = in_ranges(ranges, c);
+    return ret;
+}
+
+/// Push `cp` encoded in UTF-8, escaping ASCII like `push_escaped`.
+template<size_t N>
+constexpr void push_code_point(::qcpc::detail::Description<N>& desc,
+                               char32_t cp,
+                               std::string_view specials) noexcept {
+    if (cp < 0x80) return desc.push_escaped(static_cast<char>(cp), specials);
+    if (cp < 0x800) {
+        desc.push(static_cast<char>(0xc0 | cp >> 6));
+    } else if (cp < 0x10000) {
+        desc.push(static_cast<char>(0xe0 | cp >> 12));
+        desc.push(static_cast<char>(0x80 | (cp >> 6 & 0x3f)));
+    } else {
+        desc.push(static_cast<char>(0xf0 | cp >> 18));
+        desc.push(static_cast<char>(0x80 | (cp >> 12 & 0x3f)));
+        desc.push(static_cast<char>(0x80 | (cp >> 6 & 0x3f)));
+    }
+    desc.push(static_cast<char>(0x80 | (cp & 0x3f)));
+}
+
+}  // namespace detail
+
+/// Match and consume any given code point once.
+/// `utf8::one<U'α', U'β'>` means `[αβ]` in PEG.
+template<char32_t... Cs>
+struct One {
+    QCPC_DETAIL_DEFINE_PARSE(One) {
+        char32_t cp;
+        size_t size = detail::peek(in, cp);
+        if (size == 0 || !((cp == Cs) || ...)) return false;
+        in.advance(size);
+        return true;
+    }
+
+    constexpr static auto expected = [] {
+        ::qcpc::detail::Description<4 * sizeof...(Cs) + 2> ret;
+        if constexpr (sizeof...(Cs) == 1) {
+            ret.push('\'');
+            (detail::push_code_point(ret, Cs, "'"), ...);
+            ret.push('\'');
+        } else {
+            ret.push('[');
+            (detail::push_code_point(ret, Cs, "[]-^"), ...);
+            ret.push(']');
+        }
+        return ret;
+    }();
+};
+
+template<char32_t... Cs>
+inline constexpr One<Cs...> one{};
+
+/// Match and consume any code point once. Fail at the end of input or an invalid sequence.
+struct Any {
+    QCPC_DETAIL_DEFINE_PARSE(Any) {
+        char32_t cp;
+        size_t size = detail::peek(in, cp);
+        if (size == 0) return false;
+        in.advance(size);
+        return true;
+    }
+
+    constexpr static std::string_view expected = "any character";
+};
+
+inline constexpr Any any{};
+
+/// Match and consume a code point in given range(s).
+/// `utf8::range<U'α', U'ω', U'_'>` means `[α-ω_]` in PEG.
+template<char32_t... Cs>
+struct Range {
+    QCPC_DETAIL_DEFINE_PARSE(Range) {
+        static_assert(check_ranges(), "invalid range");
+
+        char32_t cp;
+        size_t size = detail::peek(in, cp);
+        if (size == 0) return false;
+        bool res = false;
+        for (size_t i = 0; i + 1 < len; i += 2) res |= cs[i] <= cp && cp <= cs[i + 1];
+        if constexpr (len % 2 == 1) res |= cp == cs[len - 1];
+
+        if (res) in.advance(size);
+        return res;
+    }
+
+    constexpr static auto expected = [] {
+        constexpr char32_t chars[] = {Cs...};
+        constexpr size_t size = sizeof...(Cs);
+        ::qcpc::detail::Description<4 * size + 2 + size / 2> ret;
+        ret.push('[');
+        for (size_t i = 0; i + 1 < size; i += 2) {
+            detail::push_code_point(ret, chars[i], "[]-^");
+            ret.push('-');
+            detail::push_code_point(ret, chars[i + 1], "[]-^");
+        }
+        if constexpr (size % 2 == 1) detail::push_code_point(ret, chars[size - 1], "[]-^");
+        ret.push(']');
+        return ret;
+    }();
+
+  private:
+    constexpr static char32_t cs[] = {Cs...};
+    constexpr static size_t len = sizeof...(Cs);
+
+    [[nodiscard]] consteval static bool check_ranges() noexcept {
+        for (size_t i = 0; i + 1 < len; i += 2) {
+            if (cs[i] > cs[i + 1]) return false;
+        }
+        return true;
+    }
+};
+
+template<char32_t... Cs>
+inline constexpr Range<Cs...> range{};
+
+/// Match and consume a code point with the Unicode property `XID_Start`, e.g. letters.
+struct XidStart {
+    QCPC_DETAIL_DEFINE_PARSE(XidStart) {
+        char32_t cp;
+        size_t size = detail::peek(in, cp);
+        if (size == 0 || !(cp < 128 ? ascii[cp] : detail::in_ranges(detail::xid_start_ranges, cp)))
+            return false;
+        in.advance(size);
+        return true;
+    }
+
+    constexpr static std::string_view expected = "XID_Start";
+
+  private:
+    constexpr static auto ascii = detail::ascii_table(detail::xid_start_ranges);
+};
+
+inline constexpr XidStart xid_start{};
+
+/// Match and consume a code point with the Unicode property `XID_Continue`, e.g. letters, digits
+/// and `_`.
+struct XidContinue {
+    QCPC_DETAIL_DEFINE_PARSE(XidContinue) {
+        char32_t cp;
+        size_t size = detail::peek(in, cp);
+        if (size == 0 ||
+            !(cp < 128 ? ascii[cp] : detail::in_ranges(detail::xid_continue_ranges, cp)))
+            return false;
+        in.advance(size);
+        return true;
+    }
+
+    constexpr static std::string_view expected = "XID_Continue";
+
+  private:
+    constexpr static auto ascii = detail::ascii_table(detail::xid_continue_ranges);
+};
+
+inline constexpr XidContinue xid_continue{};
+
+// Identifiers of Unicode Standard Annex #31, with `_` allowed first.
+
+inline constexpr auto ident_first = xid_start | ::qcpc::one<'_'>;
+
+inline constexpr auto ident_other = xid_continue;
+
+inline constexpr auto ident = ident_first & *ident_other;
+
+}  // namespace qcpc::utf8
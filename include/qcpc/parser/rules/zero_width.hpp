@@ -9,6 +9,8 @@ struct Boi {
     QCPC_DETAIL_DEFINE_PARSE(Boi) {
         return in.is_boi();
     }
+
+    constexpr static std::string_view expected = "beginning of input";
 };
 
 inline constexpr Boi boi{};
@@ -18,6 +20,8 @@ struct Eoi {
     QCPC_DETAIL_DEFINE_PARSE(Eoi) {
         return in.is_eoi();
     }
+
+    constexpr static std::string_view expected = "end of input";
 };
 
 inline constexpr Eoi eoi{};
@@ -27,6 +31,8 @@ struct Bol {
     QCPC_DETAIL_DEFINE_PARSE(Bol) {
         return in.column() == 0;
     }
+
+    constexpr static std::string_view expected = "beginning of line";
 };
 
 inline constexpr Bol bol{};
@@ -34,20 +40,21 @@ inline constexpr Bol bol{};
 /// Match the end of lines. Consume "\r\n" or "\n".
 struct Eol {
     QCPC_DETAIL_DEFINE_PARSE(Eol) {
-        auto pos = in.pos();
+        // Padding after the end of input reads as zeros, which are no line breaks.
+        constexpr bool unchecked = Input::padding >= 2;
+        if (!unchecked && in.is_eoi()) return false;
         if (*in == '\n') {
             ++in;
             return true;
         }
-        if (*in == '\r') {
-            if (*++in == '\n') {
-                ++in;
-                return true;
-            }
-            in.jump(pos);
+        if (*in == '\r' && (unchecked || in.size() > 1) && in[1] == '\n') {
+            in.advance(2);
+            return true;
         }
         return false;
     }
+
+    constexpr static std::string_view expected = "end of line";
 };
 
 inline constexpr Eol eol{};
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "parser.hpp"
+
+namespace qcpc {
+
+/// Result of `scan`: the number of matches reported, and why the scan stopped early if it did.
+struct ScanResult {
+    size_t matches = 0;
+    AbortReason reason = AbortReason::None;
+};
+
+namespace detail {
+
+/// Call `callback` with `token`. Return false if it returns false to stop the scan.
+template<class F>
+bool report(F& callback, Token&& token) {
+    if constexpr (std::is_same_v<std::invoke_result_t<F&, Token&&>, bool>) {
+        return callback(std::move(token));
+    } else {
+        callback(std::move(token));
+        return true;
+    }
+}
+
+/// Scan `in` from its current position for matches of `Rule` beginning before `stop`, or
+/// anywhere if it is null, see `scan`. Matches may extend past `stop`.
+template<class Rule, InputType Input, class F>
+ScanResult scan_until(Input& in, const char* stop, F& callback, const ParseOptions& opts) {
+    State st(opts, in.current(), Input::is_utf8);
+    st.begin_quiet();
+    Token::Children out(st.resource());
+    ScanResult ret;
+    while (st.reason() == AbortReason::None && !in.is_eoi() && (!stop || in.current() < stop)) {
+        if constexpr (FirstChars<Rule>::known) {
+            // Only positions a match can begin at are tried.
+            const char* end = stop ? std::min(in.end(), stop) : in.end();
+            const char* p = next_candidate<Rule>(in.current(), end);
+            in.advance_to(p);
+            if (p == end) continue;
+        }
+        auto pos = in.pos();
+        if (Rule::parse(in, out, st) && in.current() != pos.current) {
+            ret.matches += 1;
+            bool more = report(callback, std::move(out.back()));
+            out.clear();
+            if (!more) break;
+        } else {
+            in.jump(pos);
+            out.clear();
+            st.clear_hard_failure();
+            ++in;
+        }
+        // Later attempts never begin before the current position.
+        st.commit(in.current());
+    }
+    ret.reason = st.reason();
+    return ret;
+}
+
+}  // namespace detail
+
+/// Find every non-overlapping match of `Rule` in `in`, like searching with a regular expression,
+/// and pass each one as a `Token` to `callback`, in input order. A match resumes the search at its
+/// end, and empty matches are skipped. If `callback` returns `bool`, `false` stops the scan.
+///
+/// If the characters a match may begin with are known from the rule, e.g. it begins with a
+/// string or a character class, other positions are skipped with `memchr` or SSE2 and the rule
+/// is only tried at candidates. Otherwise it is tried at every position. Attempts share a memo,
+/// so overlapping attempts do not redo work.
+template<detail::GeneratedRule Rule, InputType Input, class F>
+ScanResult scan(Rule, Input& in, F&& callback, const ParseOptions& opts = {})
+    requires(!Rule::is_silent)
+{
+    typename Input::ParseAs& base = in;
+    return detail::scan_until<Rule>(base, nullptr, callback, opts);
+}
+
+/// Like `scan`, over `text` split into one chunk per thread. Matches are reported in input order
+/// after all threads finish, and are the same as those of `scan` over `text`.
+///
+/// Each thread scans for matches beginning in its chunk, which may extend into the next chunk.
+/// Where such a match overlaps matches found by the next thread, the overlapped part is scanned
+/// again until both agree. Tokens count lines and columns from the beginning of `text`.
+///
+/// `opts.memory_resource` is ignored: threads would share it, and resources such as
+/// `std::pmr::monotonic_buffer_resource` are not thread-safe. Tokens use the default resource.
+template<detail::GeneratedRule Rule, class F>
+ScanResult scan_parallel(Rule,
+                         std::string_view text,
+                         F&& callback,
+                         size_t threads = std::thread::hardware_concurrency(),
+                         const ParseOptions& opts = {})
+    requires(!Rule::is_silent)
+{
+    // Small chunks are not worth a thread.
+    threads = std::max<size_t>(1, std::min<size_t>(threads, text.size() / 4096 + 1));
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    struct Chunk {
+        InputPos start;
+        std::vector<Token> tokens;
+        ScanResult result;
+    };
+    std::vector<Chunk> chunks(threads);
+    ParseOptions chunk_opts = opts;
+    chunk_opts.memory_resource = nullptr;
+    for (size_t i = 0; i < threads; ++i)
+        chunks[i].start.current = begin + text.size() * i / threads;
+
+    auto work = [&](size_t i) {
+        Chunk& chunk = chunks[i];
+        const char* stop = i + 1 < threads ? chunks[i + 1].start.current : end;
+        MemoryInput in(begin, end);
+        in.advance_to(chunk.start.current);
+        chunk.start = in.pos();
+        auto collect = [&chunk](Token&& token) { chunk.tokens.push_back(std::move(token)); };
+        chunk.result = detail::scan_until<Rule>(in, stop, collect, chunk_opts);
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; ++i) workers.emplace_back(work, i);
+    work(0);
+    for (auto& worker: workers) worker.join();
+
+    ScanResult ret;
+    bool stopped = false;
+    auto emit = [&](Token&& token) {
+        ret.matches += 1;
+        stopped = !detail::report(callback, std::move(token));
+        return !stopped;
+    };
+    const char* resume = begin;  // where a sequential scan continues
+    for (Chunk& chunk: chunks) {
+        if (chunk.result.reason != AbortReason::None) return {ret.matches, chunk.result.reason};
+        auto it = chunk.tokens.begin();
+        while (true) {
+            while (it != chunk.tokens.end() && it->end() <= resume) ++it;
+            // The thread scanned from every position not inside its matches like a sequential
+            // scan, so they agree from there on.
+            if (it == chunk.tokens.end() || resume <= it->begin()) break;
+            MemoryInput in(begin, end);
+            in.jump(chunk.start);
+            in.advance_to(resume);
+            auto result = detail::scan_until<Rule>(in, it->end(), emit, opts);
+            if (stopped || result.reason != AbortReason::None) return {ret.matches, result.reason};
+            resume = in.current();
+        }
+        for (; it != chunk.tokens.end(); ++it) {
+            resume = it->end();
+            if (!emit(std::move(*it))) return ret;
+        }
+    }
+    return ret;
+}
+
+}  // namespace qcpc
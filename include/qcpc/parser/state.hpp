@@ -0,0 +1,390 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <new>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "../input/input.hpp"
+#include "result.hpp"
+#include "rule_tag.hpp"
+#include "token.hpp"
+
+namespace qcpc {
+
+/// Options of a single parse.
+struct ParseOptions {
+    /// Maximum nesting depth of generated rules, or of rule calls for `vm::parse`.
+    size_t max_depth = SIZE_MAX;
+
+    /// Maximum bytes of native stack a parse may use. Nesting deeper fails the parse instead of
+    /// overflowing the thread stack. Lower it for threads with small stacks.
+    size_t stack_budget = size_t(1) << 20;
+
+    /// Maximum number of generated rule invocations, or of rule calls for `vm::parse`.
+    size_t max_steps = SIZE_MAX;
+
+    /// Point of time after which the parse is aborted.
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    /// Abort the parse once it becomes `true`, e.g. when set by another thread.
+    const std::atomic<bool>* cancel = nullptr;
+
+    /// Memory of the tokens and the memo of the parse, or the default resource if null. A
+    /// `std::pmr::monotonic_buffer_resource` per request frees all of them at once. The resource
+    /// must outlive the returned tokens.
+    std::pmr::memory_resource* memory_resource = nullptr;
+};
+
+namespace detail {
+
+using MemKey = std::tuple<const char*, const void*>;
+
+struct MemKeyHash {
+    size_t operator()(MemKey key) const noexcept {
+        auto [pos, rule] = key;
+        auto h1 = std::hash<decltype(pos)>{}(pos);
+        auto h2 = std::hash<decltype(rule)>{}(rule);
+        return h1 ^ (h2 << 1);
+    }
+};
+
+using MemMap = std::pmr::unordered_map<MemKey, InputPos, MemKeyHash>;
+
+/// Allocate with plain `operator new`. `std::pmr::new_delete_resource` always calls the aligned
+/// overload, which is slower on common implementations.
+struct HeapResource final: std::pmr::memory_resource {
+  private:
+    void* do_allocate(size_t bytes, size_t align) override {
+        if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            return ::operator new(bytes, std::align_val_t(align));
+        return ::operator new(bytes);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t align) override {
+        if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            ::operator delete(ptr, bytes, std::align_val_t(align));
+        else
+            ::operator delete(ptr, bytes);
+    }
+
+    [[nodiscard]] bool do_is_equal(const memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/// Return the resource of parses without `ParseOptions::memory_resource`: the default resource,
+/// or `HeapResource` in place of `std::pmr::new_delete_resource`.
+[[nodiscard]] inline std::pmr::memory_resource* default_resource() noexcept {
+    static HeapResource heap;
+    std::pmr::memory_resource* ret = std::pmr::get_default_resource();
+    return ret == std::pmr::new_delete_resource() ? &heap : ret;
+}
+
+/// An error recovered by `recover`, reported only if its error token is in the final tree.
+struct Recovery {
+    const char* begin;  // of the error token
+    ParseError error;
+};
+
+/// Return an address near the top of the native stack.
+[[nodiscard]] inline uintptr_t stack_address() noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+#else
+    char probe = 0;
+    return reinterpret_cast<uintptr_t>(&probe);
+#endif
+}
+
+/// Mutable state shared by all rules of a single parse.
+struct State {
+    /// Rule entries between two polls of the deadline and the cancellation flag.
+    constexpr static size_t POLL_INTERVAL = 1024;
+
+    /// Capacity of the expected set. More entries are dropped.
+    constexpr static size_t MAX_EXPECTED = 16;
+
+    /// Size of the memo below which `commit` does not bother.
+    constexpr static size_t MIN_PRUNE_SIZE = 1024;
+
+    MemMap mem;
+    std::vector<Recovery> recoveries{};
+
+    /// `utf8_columns` makes errors count columns in code points, see `InputCRTP::is_utf8`.
+    State(const ParseOptions& opts, const char* start, bool utf8_columns = false) noexcept
+        : mem(opts.memory_resource ? opts.memory_resource : default_resource()),
+          _opts(opts),
+          _depth_left(opts.max_depth),
+          _steps_left(opts.max_steps),
+          _farthest(start),
+          _utf8_columns(utf8_columns) {
+        // Stacks grow downwards on all supported platforms.
+        uintptr_t base = stack_address();
+        this->_stack_budget_limit = base > opts.stack_budget ? base - opts.stack_budget : 0;
+        this->_stack_limit = this->_stack_budget_limit;
+        this->_refill();
+    }
+
+    /// Enter a rule. Return false if the parse should stop, after which it always returns false
+    /// so that the parse unwinds promptly.
+    [[nodiscard]] bool enter() noexcept {
+        // One branch on the fast path, limits and polls are handled out of line.
+        if (this->_depth_left == 0 || --this->_countdown == 0 ||
+            stack_address() < this->_stack_limit) [[unlikely]]
+            return this->_enter_slow();
+        this->_depth_left -= 1;
+        return true;
+    }
+
+    /// Leave a rule entered successfully.
+    void leave() noexcept {
+        this->_depth_left += 1;
+    }
+
+    /// Return the memory resource of tokens, see `ParseOptions::memory_resource`.
+    [[nodiscard]] std::pmr::memory_resource* resource() const noexcept {
+        return this->mem.get_allocator().resource();
+    }
+
+    /// Return why the parse stopped, or `AbortReason::None`.
+    [[nodiscard]] AbortReason reason() const noexcept {
+        return this->_reason;
+    }
+
+    /// Record that a terminal expecting `what` failed at `at`.
+    void expect(const char* at, std::string_view what) noexcept {
+        if (at >= this->_farthest) this->_expect_slow(at, {what, false});
+    }
+
+    /// Record that a rule named `name` failed at `at`. Only counted if `at` is the farthest
+    /// position, i.e. the rule failed right at its beginning.
+    void expect_rule(const char* at, std::string_view name) noexcept {
+        if (at == this->_farthest) this->_expect_slow(at, {name, true});
+    }
+
+    /// Fail the parse from here on, like an abort, but as a mismatch at the farthest failure.
+    /// Only `recover` stops it.
+    void fail_hard() noexcept {
+        if (this->_failed_hard) return;
+        this->_failed_hard = true;
+        this->_quiet += 1;  // keep the failure that caused it
+        this->_stack_limit = UINTPTR_MAX;
+    }
+
+    [[nodiscard]] bool failed_hard() const noexcept {
+        return this->_failed_hard;
+    }
+
+    /// Resume the parse after a hard failure.
+    void clear_hard_failure() noexcept {
+        if (!this->_failed_hard || this->_reason != AbortReason::None) return;
+        this->_failed_hard = false;
+        this->_quiet -= 1;
+        this->_stack_limit = this->_stack_budget_limit;
+    }
+
+    /// Enter a choice point which may backtrack to `at`. Return the previous floor, to be passed
+    /// to `end_choice`.
+    [[nodiscard]] uintptr_t begin_choice(const char* at) noexcept {
+        uintptr_t ret = this->_floor;
+        this->_floor = std::min(ret, reinterpret_cast<uintptr_t>(at));
+        return ret;
+    }
+
+    void end_choice(uintptr_t floor) noexcept {
+        this->_floor = floor;
+    }
+
+    /// Drop memo entries no active choice point can backtrack to, i.e. before `at` and the floor
+    /// of choice points. Done when the memo doubles since the last time, so that it is amortized.
+    void commit(const char* at) {
+        if (this->mem.size() < this->_prune_size) return;
+        const char* floor = reinterpret_cast<const char*>(
+            std::min(this->_floor, reinterpret_cast<uintptr_t>(at)));
+        std::erase_if(this->mem, [floor](const auto& entry) {
+            return std::get<0>(entry.first) < floor;
+        });
+        this->_prune_size = std::max(MIN_PRUNE_SIZE, this->mem.size() * 2);
+    }
+
+    /// Failures between `begin_quiet` and `end_quiet` are not recorded, e.g. inside predicates.
+    void begin_quiet() noexcept {
+        this->_quiet += 1;
+    }
+
+    void end_quiet() noexcept {
+        this->_quiet -= 1;
+    }
+
+    /// Return the farthest failure, with line and column counted from `start`.
+    [[nodiscard]] ParseError error(InputPos start) const {
+        ParseError ret = this->error();
+        locate(ret, start);
+        return ret;
+    }
+
+    /// Return the farthest failure without line and column, for inputs which locate it themselves.
+    [[nodiscard]] ParseError error() const {
+        return {this->_farthest, 0, 0, this->_expected_list()};
+    }
+
+    /// The farthest failure and what was expected there.
+    struct Farthest {
+        const char* at;
+        size_t size;
+        std::array<Expected, MAX_EXPECTED> expected;
+    };
+
+    /// Start recording failures of a match which may be recovered, from `at` afresh. Return the
+    /// failures recorded so far, to be passed to `end_recoverable` if the match succeeds.
+    [[nodiscard]] Farthest begin_recoverable(const char* at) noexcept {
+        Farthest ret{this->_farthest, this->_expected_size, this->_expected};
+        this->_farthest = at;
+        this->_expected_size = 0;
+        return ret;
+    }
+
+    void end_recoverable(const Farthest& saved) noexcept {
+        if (saved.at <= this->_farthest) return;
+        this->_farthest = saved.at;
+        this->_expected_size = saved.size;
+        this->_expected = saved.expected;
+    }
+
+    /// Record that an error token from `begin` to `resume` replaced a failed match started by
+    /// `begin_recoverable`. Failures are then recorded from `resume` afresh.
+    void recovered(const char* begin, const char* resume) {
+        this->recoveries.push_back({begin, {this->_farthest, 0, 0, this->_expected_list()}});
+        this->_farthest = resume;
+        this->_expected_size = 0;
+    }
+
+    /// Return the errors recovered by the error tokens in `root`, in input order, with line and
+    /// column counted from `start`. Recoveries undone by backtracking are dropped.
+    [[nodiscard]] std::vector<ParseError> diagnostics(const Token& root, InputPos start) {
+        std::vector<ParseError> ret = this->diagnostics(root);
+        for (auto& error: ret) locate(error, start);
+        return ret;
+    }
+
+    /// Return the recovered errors like above, without line and column.
+    [[nodiscard]] std::vector<ParseError> diagnostics(const Token& root) {
+        std::vector<ParseError> ret;
+        if (this->recoveries.empty()) return ret;
+
+        // A backtracked recovery may be redone at the same place, the last one wins.
+        std::unordered_map<const char*, size_t> latest;
+        for (size_t i = 0; i < this->recoveries.size(); ++i)
+            latest[this->recoveries[i].begin] = i;
+        std::vector<const Token*> pending{&root};
+        while (!pending.empty()) {
+            const Token* token = pending.back();
+            pending.pop_back();
+            if (token->tag() == ERROR_RULE) {
+                auto it = latest.find(token->begin());
+                if (it != latest.end())
+                    ret.push_back(std::move(this->recoveries[it->second].error));
+            }
+            for (const auto& child: token->children) pending.push_back(&child);
+        }
+
+        std::sort(ret.begin(), ret.end(), [](const ParseError& a, const ParseError& b) {
+            return a.position < b.position;
+        });
+        return ret;
+    }
+
+    /// Set line and column of `error`, counting from `from`, which is moved to its position.
+    void locate(ParseError& error, InputPos& from) const noexcept {
+        for (; from.current != error.position; ++from.current) {
+            if (*from.current == '\n') {
+                from.line += 1;
+                from.column = 0;
+            } else if (!this->_utf8_columns ||
+                       (static_cast<unsigned char>(*from.current) & 0xc0) != 0x80) {
+                from.column += 1;
+            }
+        }
+        error.line = from.line;
+        error.column = from.column;
+    }
+
+  private:
+    const ParseOptions& _opts;
+    size_t _depth_left;
+    size_t _steps_left;
+    size_t _chunk = 0;      // steps counted by the current countdown
+    size_t _countdown = 0;  // steps until the next poll
+    uintptr_t _stack_limit;
+    uintptr_t _stack_budget_limit;
+    uintptr_t _floor = UINTPTR_MAX;  // lowest position of active choice points
+    size_t _prune_size = MIN_PRUNE_SIZE;
+    AbortReason _reason = AbortReason::None;
+    bool _failed_hard = false;
+    const char* _farthest;
+    bool _utf8_columns;
+    size_t _quiet = 0;
+    size_t _expected_size = 0;
+    std::array<Expected, MAX_EXPECTED> _expected{};
+
+    [[nodiscard]] std::vector<Expected> _expected_list() const {
+        return {this->_expected.begin(), this->_expected.begin() + this->_expected_size};
+    }
+
+    void _expect_slow(const char* at, Expected what) noexcept {
+        if (this->_quiet != 0) return;
+        if (at > this->_farthest) {
+            this->_farthest = at;
+            this->_expected_size = 0;
+        }
+        for (size_t i = 0; i < this->_expected_size; ++i) {
+            if (this->_expected[i].name == what.name) return;
+        }
+        if (this->_expected_size < MAX_EXPECTED) this->_expected[this->_expected_size++] = what;
+    }
+
+    void _refill() noexcept {
+        // Stop exactly at the step exceeding the budget.
+        this->_chunk = this->_steps_left < POLL_INTERVAL ? this->_steps_left + 1 : POLL_INTERVAL;
+        this->_countdown = this->_chunk;
+    }
+
+    [[nodiscard]] bool _enter_slow() noexcept {
+        if (this->_reason != AbortReason::None) return false;
+        if (this->_countdown == 0) {
+            if (this->_chunk > this->_steps_left) return this->_abort(AbortReason::OutOfSteps);
+            this->_steps_left -= this->_chunk;
+            if (this->_opts.cancel && this->_opts.cancel->load(std::memory_order_relaxed))
+                return this->_abort(AbortReason::Cancelled);
+            if (this->_opts.deadline != std::chrono::steady_clock::time_point::max() &&
+                std::chrono::steady_clock::now() >= this->_opts.deadline)
+                return this->_abort(AbortReason::Timeout);
+            this->_refill();
+        }
+        if (this->_failed_hard) return false;
+        if (this->_depth_left == 0 || stack_address() < this->_stack_limit)
+            return this->_abort(AbortReason::TooDeep);
+        this->_depth_left -= 1;
+        return true;
+    }
+
+    [[nodiscard]] bool _abort(AbortReason reason) noexcept {
+        this->_reason = reason;
+        this->_stack_limit = UINTPTR_MAX;  // fail every later entry
+        return false;
+    }
+};
+
+}  // namespace detail
+
+}  // namespace qcpc
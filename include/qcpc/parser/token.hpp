@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory_resource>
 #include <string_view>
 #include <vector>
 
@@ -24,7 +25,8 @@ struct TokenPos {
 };
 
 struct Token {
-    using Children = std::vector<Token>;
+    /// Children share the memory resource of the parse, see `ParseOptions::memory_resource`.
+    using Children = std::pmr::vector<Token>;
 
     Children children;
 
@@ -36,6 +38,21 @@ struct Token {
     Token& operator=(const Token&) = delete;
     Token& operator=(Token&&) = default;
 
+    /// Destroy descendants iteratively, since recursion would overflow the stack on deep trees.
+    ~Token() {
+        std::pmr::vector<Children> pending(this->children.get_allocator());
+        for (auto& child: this->children) {
+            if (!child.children.empty()) pending.push_back(std::move(child.children));
+        }
+        while (!pending.empty()) {
+            Children current = std::move(pending.back());
+            pending.pop_back();
+            for (auto& child: current) {
+                if (!child.children.empty()) pending.push_back(std::move(child.children));
+            }
+        }
+    }
+
     /// Return the position of this token.
     [[nodiscard]] TokenPos pos() const noexcept {
         return this->_pos;
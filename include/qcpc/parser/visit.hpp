@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "rule_index.hpp"
+#include "rule_tag.hpp"
+#include "token.hpp"
+
+namespace qcpc {
+
+/// Dense id of a rule in a `RuleIndex` as a type, so that visitors can tell rules apart at
+/// compile time, e.g. `if constexpr (id == CalcRules::id<value>)`.
+template<size_t Id>
+using RuleId = std::integral_constant<size_t, Id>;
+
+/// `root` and its descendants, parents before children, in input order. The tree is walked with
+/// an explicit stack, so deep trees do not overflow the native stack.
+class Preorder {
+  public:
+    class iterator {
+      public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Token;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() noexcept = default;
+
+        explicit iterator(const Token& root): _stack{&root} {}
+
+        [[nodiscard]] const Token& operator*() const noexcept {
+            return *this->_stack.back();
+        }
+
+        [[nodiscard]] const Token* operator->() const noexcept {
+            return this->_stack.back();
+        }
+
+        iterator& operator++() {
+            const Token* token = this->_stack.back();
+            this->_stack.pop_back();
+            for (auto it = token->children.rbegin(); it != token->children.rend(); ++it)
+                this->_stack.push_back(&*it);
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        [[nodiscard]] bool operator==(std::default_sentinel_t) const noexcept {
+            return this->_stack.empty();
+        }
+
+      private:
+        std::vector<const Token*> _stack;
+    };
+
+    explicit Preorder(const Token& root) noexcept: _root(&root) {}
+
+    [[nodiscard]] iterator begin() const {
+        return iterator(*this->_root);
+    }
+
+    [[nodiscard]] std::default_sentinel_t end() const noexcept {
+        return {};
+    }
+
+  private:
+    const Token* _root;
+};
+
+/// `root` and its descendants, children before parents, in input order. See `Preorder`.
+class Postorder {
+  public:
+    class iterator {
+      public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Token;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() noexcept = default;
+
+        explicit iterator(const Token& root) {
+            this->_descend(&root);
+        }
+
+        [[nodiscard]] const Token& operator*() const noexcept {
+            return *this->_stack.back().token;
+        }
+
+        [[nodiscard]] const Token* operator->() const noexcept {
+            return this->_stack.back().token;
+        }
+
+        iterator& operator++() {
+            this->_stack.pop_back();
+            if (!this->_stack.empty()) {
+                Frame& parent = this->_stack.back();
+                if (++parent.child < parent.token->children.size())
+                    this->_descend(&parent.token->children[parent.child]);
+            }
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        [[nodiscard]] bool operator==(std::default_sentinel_t) const noexcept {
+            return this->_stack.empty();
+        }
+
+      private:
+        struct Frame {
+            const Token* token;
+            size_t child;  // the child being visited
+        };
+
+        std::vector<Frame> _stack;
+
+        /// Push `token` and its first descendants down to a leaf, which is visited first.
+        void _descend(const Token* token) {
+            while (true) {
+                this->_stack.push_back({token, 0});
+                if (token->children.empty()) return;
+                token = &token->children[0];
+            }
+        }
+    };
+
+    explicit Postorder(const Token& root) noexcept: _root(&root) {}
+
+    [[nodiscard]] iterator begin() const {
+        return iterator(*this->_root);
+    }
+
+    [[nodiscard]] std::default_sentinel_t end() const noexcept {
+        return {};
+    }
+
+  private:
+    const Token* _root;
+};
+
+[[nodiscard]] inline Preorder preorder(const Token& root) noexcept {
+    return Preorder(root);
+}
+
+[[nodiscard]] inline Postorder postorder(const Token& root) noexcept {
+    return Postorder(root);
+}
+
+/// Call `f(RuleId<id>{}, token)` with the id of the rule of `token` in `Index`, or
+/// `RuleId<Index::size>` if it is not one of them, through a jump table. Every call must return
+/// the same type.
+template<class Index, class F>
+decltype(auto) dispatch(const Token& token, F&& f) {
+    using Ret = std::invoke_result_t<F&, RuleId<0>, const Token&>;
+    return [&]<size_t... Is>(std::index_sequence<Is...>) -> Ret {
+        constexpr Ret (*table[])(F&, const Token&) = {
+            [](F& g, const Token& t) -> Ret { return g(RuleId<Is>{}, t); }...};
+        return table[Index::of(token)](f, token);
+    }(std::make_index_sequence<Index::size + 1>{});
+}
+
+/// Call `f(RuleId<id>{}, token)` for `root` and its descendants in pre-order, see `dispatch`.
+template<class Index, class F>
+void visit(const Token& root, F&& f) {
+    for (const Token& token: preorder(root)) dispatch<Index>(token, f);
+}
+
+/// Compute a `T` for every token from those of its children, bottom-up without recursion, and
+/// return that of `root`. `f(RuleId<id>{}, token, values)` returns the value of `token`, where
+/// `values` is a `std::span<T>` of the values of its children, see `dispatch`.
+template<class Index, class T, class F>
+T fold(const Token& root, F&& f) {
+    std::vector<T> values;
+    for (const Token& token: postorder(root)) {
+        // The values of the children are the last ones computed.
+        size_t size = token.children.size();
+        std::span<T> children(values.data() + values.size() - size, size);
+        T value = dispatch<Index>(token, [&](auto id, const Token& t) -> T {
+            return f(id, t, children);
+        });
+        values.resize(values.size() - size);
+        values.push_back(std::move(value));
+    }
+    return std::move(values.back());
+}
+
+/// Call `fn` on every subtree of `root` whose tag is `tag`, e.g. top-level records, on up to
+/// `threads` threads at once. Subtrees inside a matched subtree are not visited separately. `fn`
+/// is called as `fn(subtree, index)` if it accepts it, where `index` is the position of the
+/// subtree in input order, otherwise as `fn(subtree)`. Return the number of subtrees.
+///
+/// Subtrees are handed out one at a time, so large and small ones balance across threads. `fn`
+/// must be safe to call concurrently.
+template<class F>
+size_t for_each_subtree(const Token& root,
+                        RuleTag tag,
+                        F&& fn,
+                        size_t threads = std::thread::hardware_concurrency()) {
+    std::vector<const Token*> subtrees;
+    std::vector<const Token*> stack{&root};
+    while (!stack.empty()) {
+        const Token* token = stack.back();
+        stack.pop_back();
+        if (token->tag() == tag) {
+            subtrees.push_back(token);
+            continue;
+        }
+        for (auto it = token->children.rbegin(); it != token->children.rend(); ++it)
+            stack.push_back(&*it);
+    }
+
+    std::atomic<size_t> next = 0;
+    auto work = [&] {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < subtrees.size();) {
+            if constexpr (std::is_invocable_v<F&, const Token&, size_t>)
+                fn(*subtrees[i], i);
+            else
+                fn(*subtrees[i]);
+        }
+    };
+    threads = std::max<size_t>(1, std::min(threads, subtrees.size()));
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; ++i) workers.emplace_back(work);
+    work();
+    for (auto& worker: workers) worker.join();
+    return subtrees.size();
+}
+
+}  // namespace qcpc
@@ -1,4 +1,7 @@
 #pragma once
 
 #include "input/input.hpp"
+#include "input/segmented_input.hpp"
 #include "parser/parser.hpp"
+#include "parser/scan.hpp"
+#include "parser/visit.hpp"
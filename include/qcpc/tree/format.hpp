@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+namespace qcpc::tree::detail {
+
+/// The layout of a serialized tree, in host byte order:
+///
+/// - a `Header`,
+/// - the tag table, `tag_count` 64-bit `RuleTag`s which nodes refer to by index,
+/// - `node_count` `Node`s in breadth-first order, so that the children of a node are adjacent,
+///   the root being the first,
+/// - the source text, if embedded.
+///
+/// Offsets are in bytes from the beginning of the header, and everything but the source is
+/// aligned to 8 bytes.
+struct Header {
+    constexpr static char MAGIC[8] = {'Q', 'C', 'P', 'C', 'T', 'R', 'E', 'E'};
+    constexpr static uint32_t VERSION = 1;
+    constexpr static uint32_t ENDIAN_MARK = 0x01020304;
+    constexpr static uint32_t EMBEDDED_SOURCE = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_mark;
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t tag_count;
+    uint64_t node_count;
+    uint64_t nodes_offset;
+    uint64_t source_offset;
+    uint64_t source_size;
+};
+
+static_assert(sizeof(Header) == 64);
+
+struct Node {
+    uint64_t begin;  // offset in the source text
+    uint64_t end;
+    uint64_t line;
+    uint64_t column;
+    uint64_t first_child;  // index of the first child
+    uint32_t child_count;
+    uint32_t tag;  // index in the tag table
+};
+
+static_assert(sizeof(Node) == 48);
+
+}  // namespace qcpc::tree::detail
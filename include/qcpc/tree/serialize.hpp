@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../parser/token.hpp"
+#include "format.hpp"
+
+namespace qcpc::tree {
+
+/// Serialize the tree `root`, whose tokens view `source`, in one sequential pass of `write`,
+/// which is called with `(const char* data, size_t size)` pieces. With `embed_source`, the source
+/// text follows the tree, otherwise readers must be given it.
+template<class Write>
+void serialize(const Token& root, std::string_view source, bool embed_source, Write&& write) {
+    // Number nodes breadth-first, so that the children of each node are adjacent.
+    std::vector<const Token*> order{&root};
+    std::vector<uint64_t> tags;
+    std::unordered_map<RuleTag, uint32_t> tag_index;
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (tag_index.try_emplace(order[i]->tag(), uint32_t(tags.size())).second)
+            tags.push_back(order[i]->tag());
+        for (const auto& child: order[i]->children) order.push_back(&child);
+    }
+
+    detail::Header header{};
+    std::memcpy(header.magic, detail::Header::MAGIC, sizeof(header.magic));
+    header.version = detail::Header::VERSION;
+    header.endian_mark = detail::Header::ENDIAN_MARK;
+    header.flags = embed_source ? detail::Header::EMBEDDED_SOURCE : 0;
+    header.tag_count = tags.size();
+    header.node_count = order.size();
+    header.nodes_offset = sizeof(detail::Header) + tags.size() * sizeof(uint64_t);
+    header.source_offset = header.nodes_offset + order.size() * sizeof(detail::Node);
+    header.source_size = source.size();
+    write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write(reinterpret_cast<const char*>(tags.data()), tags.size() * sizeof(uint64_t));
+
+    uint64_t next_child = 1;
+    for (const Token* token: order) {
+        detail::Node node{};
+        node.begin = token->begin() - source.data();
+        node.end = token->end() - source.data();
+        node.line = token->line();
+        node.column = token->column();
+        node.first_child = next_child;
+        node.child_count = uint32_t(token->children.size());
+        node.tag = tag_index[token->tag()];
+        next_child += node.child_count;
+        write(reinterpret_cast<const char*>(&node), sizeof(node));
+    }
+    if (embed_source) write(source.data(), source.size());
+}
+
+/// Serialize a tree into a string, see above.
+[[nodiscard]] inline std::string serialize(const Token& root,
+                                           std::string_view source,
+                                           bool embed_source = true) {
+    std::string ret;
+    serialize(root, source, embed_source, [&ret](const char* data, size_t size) {
+        ret.append(data, size);
+    });
+    return ret;
+}
+
+/// Serialize a tree into the file at `path`, see above. Return whether it is written.
+[[nodiscard]] inline bool save(const char* path,
+                               const Token& root,
+                               std::string_view source,
+                               bool embed_source = true) {
+    std::FILE* file = std::fopen(path, "wb");
+    if (!file) return false;
+    serialize(root, source, embed_source, [file](const char* data, size_t size) {
+        std::fwrite(data, 1, size, file);
+    });
+    bool ok = !std::ferror(file);
+    return std::fclose(file) == 0 && ok;
+}
+
+}  // namespace qcpc::tree
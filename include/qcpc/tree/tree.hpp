@@ -0,0 +1,5 @@
+#pragma once
+
+#include "format.hpp"
+#include "serialize.hpp"
+#include "tree_view.hpp"
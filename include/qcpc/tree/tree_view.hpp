@@ -0,0 +1,255 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+
+#include "../input/mmap_input.hpp"
+#include "../parser/rule_tag.hpp"
+#include "format.hpp"
+
+namespace qcpc::tree {
+
+class TreeView;
+
+/// A node of a serialized tree, read in place. It has the read-only interface of `Token`.
+class NodeView {
+  public:
+    /// The children of a node, adjacent in the serialized tree.
+    class Children {
+      public:
+        class iterator {
+          public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = NodeView;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() noexcept = default;
+
+            iterator(const TreeView* tree, uint64_t index) noexcept: _tree(tree), _index(index) {}
+
+            [[nodiscard]] NodeView operator*() const noexcept {
+                return {this->_tree, this->_index};
+            }
+
+            iterator& operator++() noexcept {
+                this->_index += 1;
+                return *this;
+            }
+
+            iterator operator++(int) noexcept {
+                iterator ret = *this;
+                this->_index += 1;
+                return ret;
+            }
+
+            [[nodiscard]] bool operator==(const iterator& other) const noexcept {
+                return this->_index == other._index;
+            }
+
+          private:
+            const TreeView* _tree = nullptr;
+            uint64_t _index = 0;
+        };
+
+        Children(const TreeView* tree, uint64_t first, size_t size) noexcept
+            : _tree(tree), _first(first), _size(size) {}
+
+        [[nodiscard]] size_t size() const noexcept {
+            return this->_size;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return this->_size == 0;
+        }
+
+        [[nodiscard]] NodeView operator[](size_t i) const noexcept {
+            return {this->_tree, this->_first + i};
+        }
+
+        [[nodiscard]] iterator begin() const noexcept {
+            return {this->_tree, this->_first};
+        }
+
+        [[nodiscard]] iterator end() const noexcept {
+            return {this->_tree, this->_first + this->_size};
+        }
+
+      private:
+        const TreeView* _tree;
+        uint64_t _first;
+        size_t _size;
+    };
+
+    Children children;
+
+    NodeView(const TreeView* tree, uint64_t index) noexcept;
+
+    /// Return index of this node in the serialized tree, the root being 0.
+    [[nodiscard]] uint64_t index() const noexcept {
+        return this->_index;
+    }
+
+    /// Return line number of the first character.
+    [[nodiscard]] size_t line() const noexcept {
+        return this->_node->line;
+    }
+
+    /// Return column number of the first character.
+    [[nodiscard]] size_t column() const noexcept {
+        return this->_node->column;
+    }
+
+    /// Return a pointer to the first character in the source text.
+    [[nodiscard]] const char* begin() const noexcept;
+
+    /// Return a pointer to the tail character in the source text.
+    [[nodiscard]] const char* end() const noexcept;
+
+    [[nodiscard]] std::string_view view() const noexcept {
+        return {this->begin(), this->end()};
+    }
+
+    /// Return tag of its rule.
+    [[nodiscard]] RuleTag tag() const noexcept;
+
+  private:
+    const TreeView* _tree;
+    const detail::Node* _node;
+    uint64_t _index;
+};
+
+/// A tree serialized by `tree::serialize`, read in place without deserialization. The bytes and
+/// the source text must outlive the view and nodes read from it.
+///
+/// Construction checks the header in O(1). Nodes are trusted afterwards, call `validate` on
+/// files which may be corrupted.
+class TreeView {
+  public:
+    /// View the tree in `bytes`, which must be aligned to 8 bytes. `source` is the source text of
+    /// trees serialized without it, and is ignored otherwise.
+    explicit TreeView(std::string_view bytes, std::string_view source = {}) noexcept {
+        this->_open(bytes, source);
+    }
+
+    TreeView(const TreeView&) = delete;
+    TreeView& operator=(const TreeView&) = delete;
+
+    /// Return whether the bytes hold a tree of this format and the source text fits it.
+    [[nodiscard]] bool is_valid() const noexcept {
+        return this->_nodes != nullptr;
+    }
+
+    /// Check every node refers to valid children, tags and source text, in O(n).
+    [[nodiscard]] bool validate() const noexcept {
+        if (!this->is_valid()) return false;
+        uint64_t next_child = 1;
+        for (uint64_t i = 0; i < this->_node_count; ++i) {
+            const detail::Node& node = this->_nodes[i];
+            if (node.first_child != next_child || node.tag >= this->_tag_count ||
+                node.begin > node.end || node.end > this->_source.size())
+                return false;
+            next_child += node.child_count;
+            if (next_child > this->_node_count) return false;
+        }
+        return next_child == this->_node_count;
+    }
+
+    /// Return the root node. The view must be valid.
+    [[nodiscard]] NodeView root() const noexcept {
+        return {this, 0};
+    }
+
+    /// Return number of nodes.
+    [[nodiscard]] size_t size() const noexcept {
+        return this->_node_count;
+    }
+
+    [[nodiscard]] std::string_view source() const noexcept {
+        return this->_source;
+    }
+
+    /// Return whether the source text is embedded in the serialized tree.
+    [[nodiscard]] bool has_embedded_source() const noexcept {
+        return this->_embedded;
+    }
+
+  protected:
+    TreeView() noexcept = default;
+
+    void _open(std::string_view bytes, std::string_view source) noexcept {
+        detail::Header header;
+        if (bytes.size() < sizeof(header) ||
+            reinterpret_cast<uintptr_t>(bytes.data()) % alignof(detail::Node) != 0)
+            return;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (std::memcmp(header.magic, detail::Header::MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != detail::Header::VERSION ||
+            header.endian_mark != detail::Header::ENDIAN_MARK || header.node_count == 0)
+            return;
+        // Sizes are checked by division so that huge counts can not overflow.
+        uint64_t rest = bytes.size() - sizeof(header);
+        uint64_t nodes_size = header.node_count * sizeof(detail::Node);
+        if (header.tag_count > rest / sizeof(uint64_t) ||
+            header.node_count > rest / sizeof(detail::Node) ||
+            header.nodes_offset != sizeof(header) + header.tag_count * sizeof(uint64_t) ||
+            header.source_offset != header.nodes_offset + nodes_size ||
+            header.source_offset > bytes.size())
+            return;
+        this->_embedded = header.flags & detail::Header::EMBEDDED_SOURCE;
+        if (this->_embedded) {
+            if (header.source_size != bytes.size() - header.source_offset) return;
+            source = bytes.substr(header.source_offset);
+        } else if (header.source_size != source.size()) {
+            return;
+        }
+        this->_tags = reinterpret_cast<const uint64_t*>(bytes.data() + sizeof(header));
+        this->_tag_count = header.tag_count;
+        this->_nodes = reinterpret_cast<const detail::Node*>(bytes.data() + header.nodes_offset);
+        this->_node_count = header.node_count;
+        this->_source = source;
+    }
+
+  private:
+    friend class NodeView;
+
+    const uint64_t* _tags = nullptr;
+    uint64_t _tag_count = 0;
+    const detail::Node* _nodes = nullptr;
+    uint64_t _node_count = 0;
+    std::string_view _source;
+    bool _embedded = false;
+};
+
+inline NodeView::NodeView(const TreeView* tree, uint64_t index) noexcept
+    : children(tree, tree->_nodes[index].first_child, tree->_nodes[index].child_count),
+      _tree(tree),
+      _node(&tree->_nodes[index]),
+      _index(index) {}
+
+inline const char* NodeView::begin() const noexcept {
+    return this->_tree->_source.data() + this->_node->begin;
+}
+
+inline const char* NodeView::end() const noexcept {
+    return this->_tree->_source.data() + this->_node->end;
+}
+
+inline RuleTag NodeView::tag() const noexcept {
+    return this->_tree->_tags[this->_node->tag];
+}
+
+/// A `TreeView` over a file mapped into memory, so that processes share its pages. Files that can
+/// not be opened, mapped or read as a tree give an invalid view.
+class TreeFile
+    : private ::qcpc::detail::FileMapping
+    , public TreeView {
+  public:
+    explicit TreeFile(const char* path, std::string_view source = {}) noexcept
+        : ::qcpc::detail::FileMapping(path) {
+        if (this->_is_open) this->_open({this->_data, this->_size}, source);
+    }
+};
+
+}  // namespace qcpc::tree
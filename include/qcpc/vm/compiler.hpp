@@ -0,0 +1,378 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../input/input.hpp"
+#include "grammar.hpp"
+#include "program.hpp"
+
+namespace qcpc::vm {
+
+namespace detail {
+
+/// Decode a character written by `peg_char`.
+inline char decode_char(const char*& p) noexcept {
+    auto hex = [](char c) { return c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10; };
+    if (*p != '\\') return *p++;
+    char c = p[1];
+    p += 2;
+    switch (c) {
+    case 'n': return '\n';
+    case 'r': return '\r';
+    case 't': return '\t';
+    case 'x': p += 2; return static_cast<char>(hex(p[-2]) * 16 + hex(p[-1]));
+    default: return c;
+    }
+}
+
+class Compiler {
+  public:
+    explicit Compiler(std::string* error) noexcept: _error(error) {}
+
+    std::optional<Program> compile(std::string_view source) {
+        MemoryInput in(source.data(), source.data() + source.size());
+        auto grammar = ::qcpc::parse(peg_grammar, in);
+        if (!grammar) {
+            if (is_blank(source)) return this->fail(1, 0, "empty grammar");
+            if (grammar.status() == ParseStatus::Aborted)
+                return this->fail(1, 0, "grammar is nested too deeply");
+            // The farthest failure and what was expected there.
+            const ParseError& error = grammar.error();
+            if (this->_error) *this->_error = error.message();
+            return std::nullopt;
+        }
+        this->_defs = std::move(grammar->children);
+
+        for (const auto& def: this->_defs) {
+            const Token& name = def.children[0];
+            if (this->find(name.view()) != this->_prog.rules.size())
+                return this->fail(name, "duplicate rule '" + std::string(name.view()) + "'");
+            bool silent = def.children[1].view() == "<~";
+            this->_prog.rules.push_back({std::string(name.view()),
+                                         silent ? NO_RULE : runtime_tag(name.view()),
+                                         silent,
+                                         0});
+        }
+        if (this->_prog.rules[0].is_silent)
+            return this->fail(this->_defs[0].children[0], "the first rule must not be silent");
+        if (!this->check()) return std::nullopt;
+
+        this->emit(Op::Call, 0);
+        this->emit(Op::End);
+        for (size_t i = 0; i < this->_defs.size(); ++i) {
+            auto& rule = this->_prog.rules[i];
+            rule.entry = this->here();
+            if (!rule.is_silent) this->emit(Op::Open, uint32_t(i));
+            this->expression(this->_defs[i].children[2]);
+            if (!rule.is_silent) this->emit(Op::Close);
+            this->emit(Op::Return);
+        }
+        return std::move(this->_prog);
+    }
+
+  private:
+    std::string* _error;
+    Token::Children _defs;
+    Program _prog;
+    std::vector<bool> _nullable;
+
+    /// Return whether `source` has nothing but spacing and comments.
+    [[nodiscard]] static bool is_blank(std::string_view source) {
+        MemoryInput in(source.data(), source.data() + source.size());
+        ParseOptions opts;
+        ::qcpc::detail::State st(opts, in.current());
+        Token::Children out;
+        return peg_sp.parse(in, out, st) && in.is_eoi();
+    }
+
+    std::nullopt_t fail(size_t line, size_t column, std::string_view message) {
+        if (this->_error) {
+            *this->_error = std::to_string(line) + ':' + std::to_string(column) + ": ";
+            *this->_error += message;
+        }
+        return std::nullopt;
+    }
+
+    std::nullopt_t fail(const Token& token, std::string_view message) {
+        return this->fail(token.line(), token.column(), message);
+    }
+
+    [[nodiscard]] size_t find(std::string_view name) const noexcept {
+        size_t i = 0;
+        while (i < this->_prog.rules.size() && this->_prog.rules[i].name != name) ++i;
+        return i;
+    }
+
+    // Analysis
+
+    /// Reject undefined rules, loops that may not consume, and left recursion, all of which
+    /// would make the machine fail or loop forever.
+    bool check() {
+        std::vector<const Token*> refs;
+        for (const auto& def: this->_defs) collect(def.children[2], peg_reference.tag, refs);
+        for (const Token* ref: refs) {
+            if (this->find(ref->view()) == this->_prog.rules.size()) {
+                this->fail(*ref, "undefined rule '" + std::string(ref->view()) + "'");
+                return false;
+            }
+        }
+
+        // Least fixpoint of nullability.
+        this->_nullable.assign(this->_defs.size(), false);
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (size_t i = 0; i < this->_defs.size(); ++i) {
+                if (this->_nullable[i] || !this->nullable(this->_defs[i].children[2])) continue;
+                this->_nullable[i] = changed = true;
+            }
+        }
+
+        std::vector<const Token*> prefixes;
+        for (const auto& def: this->_defs) collect(def.children[2], peg_prefix.tag, prefixes);
+        for (const Token* prefix: prefixes) {
+            const Token& last = prefix->children.back();
+            if (last.tag() != peg_quantifier.tag || last.view() == "?") continue;
+            if (this->nullable(prefix->children[prefix->children.size() - 2])) {
+                this->fail(*prefix, "loop body may accept empty input");
+                return false;
+            }
+        }
+
+        // Depth-first search for cycles of calls made without consuming input.
+        std::vector<std::vector<size_t>> edges(this->_defs.size());
+        for (size_t i = 0; i < this->_defs.size(); ++i)
+            this->left_calls(this->_defs[i].children[2], edges[i]);
+        std::vector<uint8_t> state(this->_defs.size(), 0);  // 0: new, 1: on stack, 2: done
+        for (size_t i = 0; i < this->_defs.size(); ++i) {
+            if (size_t j = find_cycle(i, edges, state); j != NONE) {
+                const Token& name = this->_defs[j].children[0];
+                this->fail(name, "rule '" + std::string(name.view()) + "' is left recursive");
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void collect(const Token& token, RuleTag tag, std::vector<const Token*>& out) {
+        if (token.tag() == tag) out.push_back(&token);
+        for (const auto& child: token.children) collect(child, tag, out);
+    }
+
+    constexpr static size_t NONE = SIZE_MAX;
+
+    /// Return a rule on a cycle reachable from rule `i`, or `NONE`.
+    static size_t find_cycle(size_t i,
+                             const std::vector<std::vector<size_t>>& edges,
+                             std::vector<uint8_t>& state) {
+        if (state[i] != 0) return state[i] == 1 ? i : NONE;
+        state[i] = 1;
+        for (size_t j: edges[i]) {
+            if (size_t k = find_cycle(j, edges, state); k != NONE) return k;
+        }
+        state[i] = 2;
+        return NONE;
+    }
+
+    bool nullable(const Token& token) const {
+        RuleTag tag = token.tag();
+        if (tag == peg_expression.tag) {
+            for (const auto& seq: token.children) {
+                if (this->nullable(seq)) return true;
+            }
+            return false;
+        } else if (tag == peg_sequence.tag) {
+            for (const auto& prefix: token.children) {
+                if (!this->nullable(prefix)) return false;
+            }
+            return true;
+        } else if (tag == peg_prefix.tag) {
+            if (token.children[0].tag() == peg_predicate.tag) return true;
+            const Token& last = token.children.back();
+            if (last.tag() != peg_quantifier.tag) return this->nullable(last);
+            return last.view() != "+" || this->nullable(token.children[token.children.size() - 2]);
+        } else if (tag == peg_reference.tag) {
+            return this->_nullable[this->find(token.view())];
+        } else if (tag == peg_literal.tag) {
+            return token.view().size() == 2;
+        } else {
+            return false;  // class and any
+        }
+    }
+
+    /// Collect rules called at the beginning of the given token.
+    void left_calls(const Token& token, std::vector<size_t>& out) const {
+        RuleTag tag = token.tag();
+        if (tag == peg_expression.tag) {
+            for (const auto& seq: token.children) this->left_calls(seq, out);
+        } else if (tag == peg_sequence.tag) {
+            for (const auto& prefix: token.children) {
+                this->left_calls(prefix, out);
+                if (!this->nullable(prefix)) break;
+            }
+        } else if (tag == peg_prefix.tag) {
+            for (const auto& child: token.children) this->left_calls(child, out);
+        } else if (tag == peg_reference.tag) {
+            out.push_back(this->find(token.view()));
+        }
+    }
+
+    // Code generation
+
+    [[nodiscard]] uint32_t here() const noexcept {
+        return uint32_t(this->_prog.code.size());
+    }
+
+    uint32_t emit(Op op, uint32_t arg = 0) {
+        this->_prog.code.push_back({op, arg});
+        this->_prog.expected.push_back(Program::NO_DESCRIPTION);
+        return this->here() - 1;
+    }
+
+    /// Emit a terminal instruction which expects `what` in PEG notation.
+    void emit_terminal(Op op, uint32_t arg, std::string_view what) {
+        auto& descriptions = this->_prog.descriptions;
+        uint32_t index = 0;
+        while (index < descriptions.size() && descriptions[index] != what) ++index;
+        if (index == descriptions.size()) descriptions.emplace_back(what);
+        this->emit(op, arg);
+        this->_prog.expected.back() = index;
+    }
+
+    void patch(uint32_t at) noexcept {
+        this->_prog.code[at].arg = this->here();
+    }
+
+    void expression(const Token& token) {
+        if (token.children.size() == 1) return this->sequence(token.children[0]);
+
+        // Choice L1; e1; Commit end; L1: Choice L2; e2; Commit end; L2: ...; en; end:
+        std::vector<uint32_t> commits;
+        for (size_t i = 0; i + 1 < token.children.size(); ++i) {
+            uint32_t choice = this->emit(Op::Choice);
+            this->sequence(token.children[i]);
+            commits.push_back(this->emit(Op::Commit));
+            this->patch(choice);
+        }
+        this->sequence(token.children.back());
+        for (uint32_t commit: commits) this->patch(commit);
+    }
+
+    void sequence(const Token& token) {
+        for (const auto& prefix: token.children) this->prefix(prefix);
+    }
+
+    void prefix(const Token& token) {
+        const Token* begin = &token.children.front();
+        const Token* end = &token.children.back() + 1;
+        const Token* pred = begin->tag() == peg_predicate.tag ? begin++ : nullptr;
+        const Token* quant = end[-1].tag() == peg_quantifier.tag ? --end : nullptr;
+
+        if (!pred) return this->suffix(*begin, quant);
+        if (pred->view() == "&") {
+            // Predicate L1; e; BackCommit L2; L1: Fail; L2:
+            uint32_t choice = this->emit(Op::Predicate);
+            this->suffix(*begin, quant);
+            uint32_t back = this->emit(Op::BackCommit);
+            this->patch(choice);
+            this->emit(Op::Fail);
+            this->patch(back);
+        } else {
+            // Predicate L; e; FailTwice; L:
+            uint32_t choice = this->emit(Op::Predicate);
+            this->suffix(*begin, quant);
+            if (!quant && begin->tag() == peg_any.tag) {
+                this->emit_terminal(Op::FailTwice, 0, "end of input");
+            } else {
+                this->emit(Op::FailTwice);
+            }
+            this->patch(choice);
+        }
+    }
+
+    void suffix(const Token& primary, const Token* quant) {
+        if (!quant) return this->primary(primary);
+        switch (quant->view()[0]) {
+        case '?': {
+            // Choice L; e; Commit L; L:
+            uint32_t choice = this->emit(Op::Choice);
+            this->primary(primary);
+            this->emit(Op::Commit, this->here() + 1);
+            this->patch(choice);
+            break;
+        }
+        case '+':
+            this->primary(primary);
+            [[fallthrough]];
+        default: {
+            if (primary.tag() == peg_class.tag) {
+                this->emit_terminal(Op::Span, this->char_set(primary), primary.view());
+                break;
+            }
+            // Choice end; L: e; PartialCommit L; end:
+            uint32_t choice = this->emit(Op::Choice);
+            uint32_t loop = this->here();
+            this->primary(primary);
+            this->emit(Op::PartialCommit, loop);
+            this->patch(choice);
+            break;
+        }
+        }
+    }
+
+    void primary(const Token& token) {
+        RuleTag tag = token.tag();
+        if (tag == peg_reference.tag) {
+            this->emit(Op::Call, uint32_t(this->find(token.view())));
+        } else if (tag == peg_literal.tag) {
+            std::string str;
+            for (const char* p = token.begin() + 1; p != token.end() - 1;) str += decode_char(p);
+            if (str.size() == 1) {
+                this->emit_terminal(Op::Char, static_cast<unsigned char>(str[0]), token.view());
+            } else if (!str.empty()) {
+                this->emit_terminal(Op::String, uint32_t(this->_prog.strings.size()), token.view());
+                this->_prog.strings.push_back(std::move(str));
+            }
+        } else if (tag == peg_class.tag) {
+            this->emit_terminal(Op::Set, this->char_set(token), token.view());
+        } else if (tag == peg_any.tag) {
+            this->emit_terminal(Op::Any, 0, "any character");
+        } else {
+            this->expression(token);
+        }
+    }
+
+    uint32_t char_set(const Token& token) {
+        CharSet set;
+        bool negated = false;
+        for (const auto& range: token.children) {
+            if (range.tag() == peg_negation.tag) {
+                negated = true;
+                continue;
+            }
+            const char* p = range.begin();
+            auto lo = static_cast<unsigned char>(decode_char(p));
+            auto hi = lo;
+            if (p != range.end()) hi = static_cast<unsigned char>(decode_char(++p));
+            for (unsigned c = lo; c <= hi; ++c) set.insert(static_cast<unsigned char>(c));
+        }
+        if (negated) {
+            for (auto& bits: set.bits) bits = ~bits;
+        }
+        this->_prog.sets.push_back(set);
+        return uint32_t(this->_prog.sets.size() - 1);
+    }
+};
+
+}  // namespace detail
+
+/// Compile a grammar in PEG notation, see `grammar.hpp`. Parsing starts from the first rule. On
+/// failure, return `std::nullopt` and write a "line:column: message" description to `error`.
+inline std::optional<Program> compile(std::string_view source, std::string* error = nullptr) {
+    return detail::Compiler(error).compile(source);
+}
+
+}  // namespace qcpc::vm
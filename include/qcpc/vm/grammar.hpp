@@ -0,0 +1,92 @@
+#pragma once
+
+#include "../parser/parser.hpp"
+
+// The grammar of grammars, written with qcpc itself. Rule definitions are only allowed in the
+// global namespace or `qcpc`, hence the `peg_` prefix.
+//
+//     # Comments start with '#'.
+//     grammar    <- spacing definition+ !.
+//     definition <- name ('<-' / '<~') expression    # '<~' defines a silent rule
+//     expression <- sequence ('/' sequence)*
+//     sequence   <- prefix*
+//     prefix     <- ('&' / '!')? primary ('?' / '*' / '+')?
+//     primary    <- name !('<-' / '<~') / literal / class / '.' / '(' expression ')'
+//     literal    <- ['] (!['] char)* ['] / ["] (!["] char)* ["]
+//     class      <- '[' '^'? (!']' range)* ']'
+//     range      <- char ('-' !']' char)?
+//     char       <- '\x' hex hex / '\' [nrt\\'"[\]\-^] / !'\' .
+
+namespace qcpc {
+
+// clang-format off
+
+QCPC_DECL(peg_expression);
+
+QCPC_DECL_DEF_(peg_sp)
+  = *(one<' ', '\t', '\r', '\n'> | (one<'#'> & *((!one<'\n'>) & any)))
+  ;
+QCPC_DECL_DEF_(peg_arrow_)
+  = QCPC_STR("<-") | QCPC_STR("<~")
+  ;
+QCPC_DECL_DEF_(peg_char)
+  = (QCPC_STR("\\x") & range<'0', '9', 'a', 'f', 'A', 'F'> & range<'0', '9', 'a', 'f', 'A', 'F'>)
+  | (one<'\\'> & one<'n', 'r', 't', '\\', '\'', '"', '[', ']', '-', '^'>)
+  | ((!one<'\\'>) & any)
+  ;
+QCPC_DECL_DEF(peg_name)
+  = ident
+  ;
+QCPC_DECL_DEF(peg_arrow)
+  = peg_arrow_
+  ;
+QCPC_DECL_DEF(peg_reference)
+  = ident & !(peg_sp & peg_arrow_)
+  ;
+QCPC_DECL_DEF(peg_literal)
+  = (one<'\''> & *((!one<'\''>) & peg_char) & one<'\''>)
+  | (one<'"'> & *((!one<'"'>) & peg_char) & one<'"'>)
+  ;
+QCPC_DECL_DEF(peg_negation)
+  = one<'^'>
+  ;
+QCPC_DECL_DEF(peg_range)
+  = peg_char & -(one<'-'> & !one<']'> & peg_char)
+  ;
+QCPC_DECL_DEF(peg_class)
+  = one<'['> & -peg_negation & *((!one<']'>) & peg_range) & one<']'>
+  ;
+QCPC_DECL_DEF(peg_any)
+  = one<'.'>
+  ;
+QCPC_DECL_DEF_(peg_group)
+  = one<'('> & peg_sp & peg_expression & one<')'>
+  ;
+QCPC_DECL_DEF(peg_predicate)
+  = one<'&', '!'>
+  ;
+QCPC_DECL_DEF(peg_quantifier)
+  = one<'?', '*', '+'>
+  ;
+QCPC_DECL_DEF(peg_prefix)
+  = -(peg_predicate & peg_sp)
+  & (peg_reference | peg_literal | peg_class | peg_any | peg_group)
+  & -peg_quantifier
+  & peg_sp
+  ;
+QCPC_DECL_DEF(peg_sequence)
+  = *peg_prefix
+  ;
+QCPC_DEF(peg_expression)
+  = peg_sequence & *(one<'/'> & peg_sp & peg_sequence)
+  ;
+QCPC_DECL_DEF(peg_definition)
+  = peg_sp & peg_name & peg_sp & peg_arrow & peg_sp & peg_expression
+  ;
+QCPC_DECL_DEF(peg_grammar)
+  = boi & +peg_definition & peg_sp & eoi
+  ;
+
+// clang-format on
+
+}  // namespace qcpc
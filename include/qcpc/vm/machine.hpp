@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "../input/input.hpp"
+#include "../parser/result.hpp"
+#include "../parser/state.hpp"
+#include "../parser/token.hpp"
+#include "program.hpp"
+
+namespace qcpc::vm {
+
+namespace detail {
+
+/// A choice point or a return address.
+struct Frame {
+    uint32_t pc;        // where to resume, or where to return
+    uint32_t rule;      // the called rule, unused by choice points
+    uint32_t captures;  // number of captures when pushed
+    bool is_choice;
+    bool is_predicate;  // a choice point of a predicate
+    InputPos pos;
+};
+
+/// Opens and closes of tokens in the order they happen. Backtracking only has to truncate this
+/// list, and the tree is built once after a successful parse.
+struct Capture {
+    constexpr static uint32_t CLOSE = UINT32_MAX;
+
+    InputPos pos;
+    uint32_t rule;  // `CLOSE` for closes
+};
+
+inline Token build_tree(const Program& prog,
+                        const std::vector<Capture>& captures,
+                        std::pmr::memory_resource* resource) {
+    std::vector<Token::Children> levels;
+    levels.emplace_back(resource);
+    std::vector<const Capture*> opens;
+    for (const auto& capture: captures) {
+        if (capture.rule != Capture::CLOSE) {
+            opens.push_back(&capture);
+            levels.emplace_back(resource);
+        } else {
+            const Capture& open = *opens.back();
+            Token::Children children = std::move(levels.back());
+            levels.pop_back();
+            levels.back().push_back(
+                {std::move(children), {open.pos, capture.pos.current}, prog.rules[open.rule].tag});
+            opens.pop_back();
+        }
+    }
+    return std::move(levels[0][0]);
+}
+
+template<InputType Input>
+ParseResult run(const Program& prog, Input& in, const ParseOptions& opts) {
+    const Instruction* const code = prog.code.data();
+    std::vector<Frame> stack;
+    std::vector<Capture> captures;
+    const InputPos start = in.pos();
+    ::qcpc::detail::State st(opts, start.current, Input::is_utf8);
+
+    uint32_t pc = 0;
+    while (true) {
+        const Instruction& inst = code[pc];
+        switch (inst.op) {
+        case Op::Any:
+            if (in.is_eoi()) goto fail;
+            ++in;
+            ++pc;
+            continue;
+        case Op::Char:
+            if (in.is_eoi() || *in != static_cast<char>(inst.arg)) goto fail;
+            ++in;
+            ++pc;
+            continue;
+        case Op::Set:
+            if (in.is_eoi() || !prog.sets[inst.arg].contains(*in)) goto fail;
+            ++in;
+            ++pc;
+            continue;
+        case Op::Span: {
+            const CharSet& set = prog.sets[inst.arg];
+            while (!in.is_eoi() && set.contains(*in)) ++in;
+            st.expect(in.current(), prog.descriptions[prog.expected[pc]]);
+            ++pc;
+            continue;
+        }
+        case Op::String: {
+            const std::string& str = prog.strings[inst.arg];
+            auto current = in.contiguous(str.size());
+            if (!current) goto fail;
+            for (size_t i = 0; i < str.size(); ++i) {
+                if (current[i] != str[i]) goto fail;
+            }
+            in.advance(str.size());
+            ++pc;
+            continue;
+        }
+        case Op::Choice:
+            stack.push_back({inst.arg, 0, uint32_t(captures.size()), true, false, in.pos()});
+            ++pc;
+            continue;
+        case Op::Predicate:
+            st.begin_quiet();
+            stack.push_back({inst.arg, 0, uint32_t(captures.size()), true, true, in.pos()});
+            ++pc;
+            continue;
+        case Op::Commit:
+            stack.pop_back();
+            pc = inst.arg;
+            continue;
+        case Op::PartialCommit:
+            stack.back().captures = uint32_t(captures.size());
+            stack.back().pos = in.pos();
+            pc = inst.arg;
+            continue;
+        case Op::BackCommit:
+            st.end_quiet();
+            in.jump(stack.back().pos);
+            captures.resize(stack.back().captures);
+            stack.pop_back();
+            pc = inst.arg;
+            continue;
+        case Op::FailTwice:
+            // Report the failure of `!.` where the predicate began.
+            st.end_quiet();
+            in.jump(stack.back().pos);
+            stack.pop_back();
+            goto fail;
+        case Op::Call: {
+            // Same memo as rules: only successes without tokens are recorded.
+            uint32_t entry = prog.rules[inst.arg].entry;
+            if (auto it = st.mem.find({in.current(), &code[entry]}); it != st.mem.end()) {
+                in.jump(it->second);
+                ++pc;
+                continue;
+            }
+            if (!st.enter()) goto stop;
+            stack.push_back({pc + 1, inst.arg, uint32_t(captures.size()), false, false, in.pos()});
+            pc = entry;
+            continue;
+        }
+        case Op::Return: {
+            const Frame& frame = stack.back();
+            st.leave();
+            if (captures.size() == frame.captures)
+                st.mem.emplace(
+                    ::qcpc::detail::MemKey{frame.pos.current, &code[prog.rules[frame.rule].entry]},
+                    in.pos());
+            pc = frame.pc;
+            stack.pop_back();
+            continue;
+        }
+        case Op::Jump:
+            pc = inst.arg;
+            continue;
+        case Op::Fail:
+            goto fail;
+        case Op::Open:
+            captures.push_back({in.pos(), inst.arg});
+            ++pc;
+            continue;
+        case Op::Close:
+            captures.push_back({in.pos(), Capture::CLOSE});
+            ++pc;
+            continue;
+        case Op::End:
+            return build_tree(prog, captures, st.resource());
+        }
+
+    fail:
+        if (uint32_t desc = prog.expected[pc]; desc != Program::NO_DESCRIPTION)
+            st.expect(in.current(), prog.descriptions[desc]);
+        while (!stack.empty() && !stack.back().is_choice) {
+            const RuleInfo& rule = prog.rules[stack.back().rule];
+            if (!rule.is_silent) st.expect_rule(stack.back().pos.current, rule.name);
+            st.leave();
+            stack.pop_back();
+        }
+        if (stack.empty()) goto stop;
+        const Frame& frame = stack.back();
+        if (frame.is_predicate) st.end_quiet();
+        in.jump(frame.pos);
+        captures.resize(frame.captures);
+        pc = frame.pc;
+        stack.pop_back();
+    }
+
+stop:
+    in.jump(start);
+    if (st.reason() != AbortReason::None) return st.reason();
+    if constexpr (Input::is_segmented) {
+        auto error = st.error();
+        in.locate(error);
+        return error;
+    } else {
+        return st.error(start);
+    }
+}
+
+}  // namespace detail
+
+/// Parse with a compiled grammar, starting from its first rule. Like `qcpc::parse`, the returned
+/// `Token`s hold views into the input object, so it must outlive them.
+///
+/// On mismatch, expected terminals are reported in the notation of the grammar source and refer
+/// to strings owned by `prog`.
+///
+/// The machine keeps its stack on the heap, so nesting depth is only bounded by
+/// `opts.max_depth` and memory. `opts.stack_budget` does not apply.
+template<InputType Input>
+ParseResult parse(const Program& prog, Input& in, const ParseOptions& opts = {}) {
+    // Inputs sharing a representation share machine instantiations.
+    typename Input::ParseAs& base = in;
+    return detail::run(prog, base, opts);
+}
+
+}  // namespace qcpc::vm
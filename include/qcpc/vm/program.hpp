@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../parser/rule_tag.hpp"
+
+namespace qcpc::vm {
+
+/// Opcodes of the parsing machine. The design follows LPeg: a backtracking machine with a single
+/// stack holding both choice points and return addresses.
+enum class Op : uint8_t {
+    Any,            ///< Consume any character.
+    Char,           ///< Consume the character `arg`.
+    Set,            ///< Consume a character in `sets[arg]`.
+    Span,           ///< Consume characters in `sets[arg]` as many as possible. Never fail.
+    String,         ///< Consume `strings[arg]`.
+    Choice,         ///< Push a choice point which resumes at `arg`.
+    Predicate,      ///< Like `Choice`, but failures are not reported until it is popped.
+    Commit,         ///< Pop a choice point and jump to `arg`.
+    PartialCommit,  ///< Update the top choice point to the current state and jump to `arg`.
+    BackCommit,     ///< Pop a choice point, restore its position and jump to `arg`.
+    FailTwice,      ///< Pop a choice point, restore its position and fail.
+    Call,           ///< Push a return address and jump to the entry of `rules[arg]`.
+    Return,         ///< Pop a return address and jump to it.
+    Jump,           ///< Jump to `arg`.
+    Fail,           ///< Backtrack to the latest choice point.
+    Open,           ///< Begin a token of `rules[arg]`.
+    Close,          ///< End the innermost open token.
+    End,            ///< Finish parsing successfully.
+};
+
+struct Instruction {
+    Op op;
+    uint32_t arg = 0;
+};
+
+/// A set of 8-bit characters.
+struct CharSet {
+    std::array<uint64_t, 4> bits{};
+
+    void insert(unsigned char c) noexcept {
+        this->bits[c >> 6] |= uint64_t(1) << (c & 63);
+    }
+
+    [[nodiscard]] bool contains(unsigned char c) const noexcept {
+        return (this->bits[c >> 6] >> (c & 63)) & 1;
+    }
+};
+
+struct RuleInfo {
+    std::string name;
+    RuleTag tag;
+    bool is_silent;
+    uint32_t entry;
+};
+
+/// A compiled grammar. The first rule is where parsing starts.
+struct Program {
+    constexpr static uint32_t NO_DESCRIPTION = UINT32_MAX;
+
+    std::vector<Instruction> code;
+    std::vector<CharSet> sets;
+    std::vector<std::string> strings;
+    std::vector<RuleInfo> rules;
+
+    /// What each instruction expects in PEG notation, as an index into `descriptions`, reported
+    /// when it fails. `NO_DESCRIPTION` for instructions that never fail this way.
+    std::vector<uint32_t> expected;
+    std::vector<std::string> descriptions;
+
+    /// Return tag of the given rule, or `NO_RULE` if it does not exist or is silent.
+    [[nodiscard]] RuleTag tag(std::string_view name) const noexcept {
+        for (const auto& rule: this->rules) {
+            if (rule.name == name) return rule.tag;
+        }
+        return NO_RULE;
+    }
+};
+
+/// Tags of runtime rules are hashes of their names.
+[[nodiscard]] constexpr RuleTag runtime_tag(std::string_view name) noexcept {
+    return detail::fnv1a(name);
+}
+
+}  // namespace qcpc::vm
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "compiler.hpp"
+#include "grammar.hpp"
+#include "machine.hpp"
+#include "program.hpp"
@@ -0,0 +1,76 @@
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "qcpc/qcpc.hpp"
+#include "qcpc/vm/vm.hpp"
+
+using namespace qcpc;
+
+QCPC_DECL_DEF(abort_digit) = range<'0', '9'>;
+QCPC_DECL_DEF(abort_digits) = *abort_digit & eoi;
+
+// Takes exponential time on unbalanced input.
+QCPC_DECL(abort_slow);
+QCPC_DEF(abort_slow) = (one<'('> & abort_slow & one<')'>) | (one<'('> & abort_slow & one<']'>) |
+                       one<'1'>;
+
+TEST(Abort, Mismatch) {
+    StringInput in("12a");
+    auto ret = parse(abort_digits, in);
+    ASSERT_FALSE(ret);
+    ASSERT_EQ(ret.status(), ParseStatus::Mismatch);
+    ASSERT_EQ(ret.reason(), AbortReason::None);
+}
+
+TEST(Abort, Steps) {
+    // One step for `abort_digits` and one for each attempt of `abort_digit`.
+    StringInput in1("123");
+    ASSERT_TRUE(parse(abort_digits, in1, {.max_steps = 5}));
+
+    StringInput in2("123");
+    auto ret = parse(abort_digits, in2, {.max_steps = 4});
+    ASSERT_EQ(ret.status(), ParseStatus::Aborted);
+    ASSERT_EQ(ret.reason(), AbortReason::OutOfSteps);
+    ASSERT_EQ(in2.current(), in2.begin());
+
+    StringInput in3(std::string(5000, '7'));
+    ASSERT_TRUE(parse(abort_digits, in3, {.max_steps = 5002}));
+
+    StringInput in4(std::string(5000, '7'));
+    ASSERT_EQ(parse(abort_digits, in4, {.max_steps = 5001}).reason(), AbortReason::OutOfSteps);
+}
+
+TEST(Abort, Deadline) {
+    StringInput in(std::string(40, '(') + "1");
+    auto begin = std::chrono::steady_clock::now();
+    auto ret = parse(abort_slow, in, {.deadline = begin + std::chrono::milliseconds(20)});
+    ASSERT_EQ(ret.reason(), AbortReason::Timeout);
+    ASSERT_LT(std::chrono::steady_clock::now() - begin, std::chrono::seconds(5));
+}
+
+TEST(Abort, Cancel) {
+    std::atomic<bool> cancel = false;
+    std::thread canceller([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        cancel = true;
+    });
+    StringInput in(std::string(40, '(') + "1");
+    auto ret = parse(abort_slow, in, {.cancel = &cancel});
+    canceller.join();
+    ASSERT_EQ(ret.reason(), AbortReason::Cancelled);
+}
+
+TEST(Abort, Machine) {
+    auto prog = vm::compile("slow <- '(' slow ')' / '(' slow ']' / '1'");
+    ASSERT_TRUE(prog);
+
+    StringInput in1(std::string(40, '(') + "1");
+    ASSERT_EQ(vm::parse(*prog, in1, {.max_steps = 100000}).reason(), AbortReason::OutOfSteps);
+
+    std::atomic<bool> cancel = true;
+    StringInput in2(std::string(40, '(') + "1");
+    ASSERT_EQ(vm::parse(*prog, in2, {.cancel = &cancel}).reason(), AbortReason::Cancelled);
+}
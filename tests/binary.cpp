@@ -0,0 +1,89 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "qcpc/qcpc.hpp"
+
+using namespace qcpc;
+
+// A count-prefixed list of records, each a type byte and a length-prefixed value.
+QCPC_DECL_DEF(bin_magic) = binary::bytes<0x89, 'Q', 'C'>;
+QCPC_DECL_DEF(bin_text) = *range<'a', 'z'> & eoi;
+QCPC_DECL_DEF(bin_number) = binary::u32be;
+QCPC_DECL_DEF(bin_record) = (binary::bytes<1> & binary::length_prefixed(binary::varint, bin_text)) |
+                            (binary::bytes<2> & binary::length_prefixed(binary::u8, bin_number)) |
+                            (binary::u8 & binary::length_prefixed(binary::u16le));
+QCPC_DECL_DEF(bin_file) = bin_magic & binary::repeat_n(binary::u16le, bin_record) & eoi;
+
+TEST(Binary, Integers) {
+    const std::string bytes("\x01\x02\x03\x04\x05\x06\x07\x08", 8);
+    ASSERT_EQ(binary::u8.value(bytes.substr(0, 1)), 0x01);
+    ASSERT_EQ(binary::u16le.value(bytes.substr(0, 2)), 0x0201);
+    ASSERT_EQ(binary::u16be.value(bytes.substr(0, 2)), 0x0102);
+    ASSERT_EQ(binary::u32le.value(bytes.substr(0, 4)), 0x04030201);
+    ASSERT_EQ(binary::u32be.value(bytes.substr(0, 4)), 0x01020304);
+    ASSERT_EQ(binary::u64le.value(bytes), 0x0807060504030201);
+    ASSERT_EQ(binary::u64be.value(bytes), 0x0102030405060708);
+    ASSERT_EQ(binary::varint.value("\xac\x02"), 300);
+    ASSERT_EQ(binary::u32be.expected, std::string_view("u32be"));
+    ASSERT_EQ(binary::any<3>.expected, std::string_view("3 bytes"));
+}
+
+TEST(Binary, Parse) {
+    const std::string data("\x89QC"
+                           "\x03\x00"
+                           "\x01\x03xyz"
+                           "\x02\x04\x00\x00\x01\x00"
+                           "\x07\x02\x00\xff\xff",
+                           21);
+    BinaryInput in(data.data(), data.data() + data.size());
+    auto ret = parse(bin_file, in);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret->children.size(), 4);
+    ASSERT_EQ(ret->children[1].children[0].view(), "xyz");
+    const Token& number = ret->children[2].children[0];
+    ASSERT_EQ(binary::u32be.value(number.view()), 256);
+    ASSERT_EQ(ret->children[3].view(), std::string_view("\x07\x02\x00\xff\xff", 5));
+    ASSERT_EQ(ret->children[3].line(), 1);
+    ASSERT_EQ(ret->children[3].column(), 0);
+}
+
+TEST(Binary, Mismatch) {
+    auto parses = [](const std::string& data) {
+        BinaryInput in(data.data(), data.data() + data.size());
+        return bool(parse(bin_file, in));
+    };
+    ASSERT_TRUE(parses(std::string("\x89QC\x01\x00\x01\x00", 7)));
+    // Too few records.
+    ASSERT_FALSE(parses(std::string("\x89QC\x02\x00\x01\x00", 7)));
+    // The body must match the whole window.
+    ASSERT_FALSE(parses(std::string("\x89QC\x01\x00\x01\x02x1", 9)));
+    // Length beyond the input.
+    ASSERT_FALSE(parses(std::string("\x89QC\x01\x00\x09\x05\x00xy", 9)));
+    // Truncated varint.
+    ASSERT_FALSE(parses(std::string("\x89QC\x01\x00\x01\x80", 7)));
+}
+
+QCPC_DECL_DEF(bin_as) = binary::length_prefixed(binary::u8, *one<'a'>) & *one<'a'>;
+QCPC_DECL_DEF(bin_numbers) = binary::length_prefixed(binary::u8, decimal) & decimal;
+QCPC_DECL_DEF(bin_str) = binary::length_prefixed(binary::u8, QCPC_STR("ab")) & one<'b'>;
+QCPC_DECL_DEF(bin_quoted) =
+    binary::length_prefixed(binary::u8, quoted<'"', '"', '\\'>) & *any & eoi;
+
+TEST(Binary, Padded) {
+    // Input follows the window rather than padding, which padded rules must not read.
+    auto same = [](auto rule, const std::string& data) {
+        StringInput plain(data);
+        PaddedStringInput padded(data);
+        auto lhs = parse(rule, plain);
+        auto rhs = parse(rule, padded);
+        EXPECT_EQ(bool(lhs), bool(rhs)) << data;
+        if (lhs && rhs) {
+            EXPECT_EQ(lhs->view(), rhs->view()) << data;
+        }
+        return bool(lhs);
+    };
+    ASSERT_TRUE(same(bin_as, "\x01" "aa"));
+    ASSERT_TRUE(same(bin_numbers, "\x02" "1234"));
+    ASSERT_FALSE(same(bin_str, "\x01" "ab"));
+    ASSERT_FALSE(same(bin_quoted, "\x02\"a\""));
+}
@@ -28,3 +28,42 @@ TEST(CompoundRule, Unwind) {
     ASSERT_TRUE(ret);
     ASSERT_EQ(ret->children.size(), 1);
 }
+
+QCPC_DECL_DEF(memo) = (ident & one<'='>) | (ident & one<';'>);
+
+TEST(CompoundRule, Memo) {
+    StringInput in("abc;");
+    auto ret = parse(memo, in);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(in.current(), in.end());
+}
+
+QCPC_DECL_INLINE(inline_expr);
+QCPC_DECL_DEF(inline_value) = range<'0', '9'> | (one<'('> & inline_expr & one<')'>);
+QCPC_DECL_DEF_INLINE(inline_product) = list(inline_value, one<'*'>);
+QCPC_DECL_DEF_INLINE(inline_sum) = list(inline_product, one<'+'>);
+QCPC_DEF(inline_expr) = inline_sum;
+
+TEST(CompoundRule, Inline) {
+    StringInput in1("7");
+    auto ret = parse(inline_expr, in1);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret->tag(), inline_value.tag);
+    ASSERT_EQ(ret->view(), "7");
+    ASSERT_TRUE(ret->children.empty());
+
+    StringInput in2("2*3+(4)");
+    ret = parse(inline_expr, in2);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret->tag(), inline_sum.tag);
+    ASSERT_EQ(ret->children.size(), 2);
+    ASSERT_EQ(ret->children[0].tag(), inline_product.tag);
+    ASSERT_EQ(ret->children[0].children.size(), 2);
+    // Only the wrappers inside the parentheses are collapsed.
+    const Token& paren = ret->children[1];
+    ASSERT_EQ(paren.tag(), inline_value.tag);
+    ASSERT_EQ(paren.view(), "(4)");
+    ASSERT_EQ(paren.children.size(), 1);
+    ASSERT_EQ(paren.children[0].tag(), inline_value.tag);
+    ASSERT_EQ(paren.children[0].view(), "4");
+}
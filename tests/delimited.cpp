@@ -0,0 +1,46 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "qcpc/qcpc.hpp"
+
+using namespace qcpc;
+
+QCPC_DECL_DEF(delim_string) = quoted<'"', '"', '\\'>;
+QCPC_DECL_DEF(delim_comment) = QCPC_STR("/*") & until<"*/">;
+QCPC_DECL_DEF(delim_line) = QCPC_STR("//") & until_any(one<'\n'>);
+QCPC_DECL_DEF(delim_item) = delim_string | delim_comment | delim_line | +range<'a', 'z'>;
+QCPC_DECL_DEF(delim_items) = list(delim_item, one<' ', '\n'>) & eoi;
+
+TEST(Delimited, Quoted) {
+    StringInput in1(R"("a \"quoted\" string that is longer than sixteen bytes\\" x)");
+    auto ret = parse(delim_items, in1);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret->children[0].children[0].view(),
+              R"("a \"quoted\" string that is longer than sixteen bytes\\")");
+
+    StringInput in2("x \"multi\nline\" y");
+    ret = parse(delim_items, in2);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret->children[2].line(), 2);
+    ASSERT_EQ(ret->children[2].column(), 6);
+
+    StringInput in3("x \"unterminated\\\"");
+    ASSERT_EQ(parse(delim_items, in3).error().message(), "1:17: expected '\"'");
+}
+
+TEST(Delimited, Until) {
+    StringInput in1("a /* b * / c\n*/ d // e */ f\ng");
+    auto ret = parse(delim_items, in1);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret->children.size(), 5);
+    ASSERT_EQ(ret->children[1].children[0].view(), "/* b * / c\n*/");
+    ASSERT_EQ(ret->children[3].children[0].view(), "// e */ f");
+    ASSERT_EQ(ret->children[4].line(), 3);
+    ASSERT_EQ(ret->children[4].column(), 0);
+
+    StringInput in2("a /* b");
+    ASSERT_EQ(parse(delim_items, in2).error().message(), "1:6: expected \"*/\"");
+
+    StringInput in3("//");
+    ASSERT_TRUE(parse(delim_items, in3));
+}
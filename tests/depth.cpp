@@ -0,0 +1,71 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "qcpc/qcpc.hpp"
+#include "qcpc/vm/vm.hpp"
+
+using namespace qcpc;
+
+QCPC_DECL(depth_expr);
+
+QCPC_DECL_DEF(depth_value) = +range<'0', '9'> | (one<'('> & depth_expr & one<')'>);
+QCPC_DECL_DEF(depth_sum) = list(depth_value, one<'+'>);
+QCPC_DEF(depth_expr) = depth_sum;
+QCPC_DECL_DEF(depth_top) = depth_expr & eoi;
+
+std::string nested(size_t depth) {
+    return std::string(depth, '(') + "1" + std::string(depth, ')');
+}
+
+TEST(Depth, Shallow) {
+    StringInput in(nested(100));
+    ASSERT_TRUE(parse(depth_top, in));
+
+    StringInput in2(nested(100));
+    auto ret = parse(depth_top, in2, {.max_depth = 100});
+    ASSERT_FALSE(ret);
+    ASSERT_EQ(ret.reason(), AbortReason::TooDeep);
+    ASSERT_EQ(in2.current(), in2.begin());
+}
+
+TEST(Depth, Pathological) {
+    // Would overflow the stack without a budget.
+    StringInput in(nested(100000));
+    auto ret = parse(depth_top, in);
+    ASSERT_TRUE(ret.is_aborted());
+    ASSERT_EQ(ret.reason(), AbortReason::TooDeep);
+    ASSERT_EQ(in.current(), in.begin());
+
+    StringInput in2(nested(100000));
+    ASSERT_FALSE(parse(depth_top, in2, {.stack_budget = 64 << 10}));
+    ASSERT_EQ(in2.current(), in2.begin());
+}
+
+QCPC_DECL(depth_twice);
+QCPC_DEF(depth_twice) = (one<'('> & depth_twice & one<')'>) | (one<'('> & depth_twice & one<']'>) |
+                        one<'1'>;
+
+TEST(Depth, Unwind) {
+    // Alternatives must not be retried once the parse is too deep, which takes exponential time.
+    StringInput in(std::string(60, '(') + "1");
+    ASSERT_TRUE(parse(depth_twice, in, {.max_depth = 50}).is_aborted());
+}
+
+TEST(Depth, Machine) {
+    auto prog = vm::compile(R"(
+        top   <- expr !.
+        expr  <- value ('+' value)*
+        value <- [0-9]+ / '(' expr ')'
+    )");
+    ASSERT_TRUE(prog);
+
+    // The machine keeps its stack on the heap, and deep trees are destroyed iteratively.
+    StringInput in(nested(100000));
+    auto ret = vm::parse(*prog, in);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(in.current(), in.end());
+
+    StringInput in2(nested(100000));
+    ASSERT_EQ(vm::parse(*prog, in2, {.max_depth = 1000}).reason(), AbortReason::TooDeep);
+    ASSERT_EQ(in2.current(), in2.begin());
+}
@@ -0,0 +1,168 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "qcpc/qcpc.hpp"
+#include "qcpc/vm/vm.hpp"
+
+using namespace qcpc;
+
+QCPC_DECL_DEF(error_number) = +range<'0', '9'>;
+QCPC_DECL_DEF_(error_sep) = *one<' ', '\n'>;
+QCPC_DECL_DEF(error_list) =
+    error_number & *(error_sep & one<','> & error_sep & error_number) & error_sep & eoi;
+QCPC_DECL_DEF(error_keyword) = QCPC_STR("let") & !range<'a', 'z'> & error_sep & error_number;
+
+TEST(Error, Farthest) {
+    StringInput in("1, 2,\n 3 x");
+    auto ret = parse(error_list, in);
+    ASSERT_EQ(ret.status(), ParseStatus::Mismatch);
+
+    const ParseError& error = ret.error();
+    ASSERT_EQ(error.position, in.begin() + 9);
+    ASSERT_EQ(error.line, 2);
+    ASSERT_EQ(error.column, 3);
+    ASSERT_EQ(error.expected.size(), 3);
+    ASSERT_EQ(error.expected[0].name, "[ \\n]");
+    ASSERT_EQ(error.expected[1].name, "','");
+    ASSERT_EQ(error.expected[2].name, "end of input");
+    ASSERT_EQ(error.message(), "2:3: expected [ \\n], ',' or end of input");
+}
+
+TEST(Error, Rules) {
+    // A rule failing where it starts is reported by its name, after what it expected.
+    StringInput in("1,");
+    auto ret = parse(error_list, in);
+    ASSERT_FALSE(ret);
+    ASSERT_EQ(ret.error().message(), "1:2: expected [ \\n], [0-9] or error_number");
+    ASSERT_FALSE(ret.error().expected[1].is_rule);
+    ASSERT_TRUE(ret.error().expected[2].is_rule);
+}
+
+TEST(Error, Predicates) {
+    // Failures inside predicates do not count, even if they get farther.
+    StringInput in("lets");
+    auto ret = parse(error_keyword, in);
+    ASSERT_FALSE(ret);
+    ASSERT_EQ(ret.error().position, in.begin());
+    ASSERT_EQ(ret.error().message(), "1:0: expected error_keyword");
+
+    StringInput in2("le");
+    ASSERT_EQ(parse(error_keyword, in2).error().message(),
+              "1:0: expected \"let\" or error_keyword");
+}
+
+TEST(Error, Machine) {
+    auto prog = vm::compile(R"(
+        list   <- number (sep ',' sep number)* sep !.
+        number <- [0-9]+
+        sep    <~ [ \n]*
+    )");
+    ASSERT_TRUE(prog);
+
+    StringInput in("1, 2,\n 3 x");
+    auto ret = vm::parse(*prog, in);
+    ASSERT_EQ(ret.status(), ParseStatus::Mismatch);
+    ASSERT_EQ(ret.error().position, in.begin() + 9);
+    ASSERT_EQ(ret.error().message(), "2:3: expected [ \\n], ',' or end of input");
+
+    StringInput in2("1,");
+    ASSERT_EQ(vm::parse(*prog, in2).error().message(), "1:2: expected [ \\n], [0-9] or number");
+}
+
+QCPC_DECL_DEF(error_field) = +range<'a', 'z'>;
+QCPC_DECL_DEF(error_record) = error_field & one<'='> & label<"a number">(error_number);
+QCPC_DECL_DEF(error_log) = *(recover(error_record, eol) & (eol | eoi)) & eoi;
+
+TEST(Error, Recover) {
+    StringInput in("a=1\nb=x\n=2\nc=3\nd=");
+    auto ret = parse(error_log, in);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret->children.size(), 5);
+    ASSERT_EQ(ret->children[0].tag(), error_record.tag);
+    ASSERT_EQ(ret->children[1].tag(), ERROR_RULE);
+    ASSERT_EQ(ret->children[1].view(), "b=x");
+    ASSERT_EQ(ret->children[2].view(), "=2");
+    ASSERT_EQ(ret->children[3].view(), "c=3");
+    ASSERT_EQ(ret->children[4].view(), "d=");
+
+    const auto& diagnostics = ret.diagnostics();
+    ASSERT_EQ(diagnostics.size(), 3);
+    ASSERT_EQ(diagnostics[0].message(), "2:2: expected a number");
+    ASSERT_EQ(diagnostics[1].message(), "3:0: expected [a-z], error_field or error_record");
+    ASSERT_EQ(diagnostics[2].message(), "5:2: expected a number");
+
+    StringInput good("a=1\n");
+    ASSERT_TRUE(parse(error_log, good)->children.size() == 1);
+    ASSERT_TRUE(parse(error_log, good).diagnostics().empty());
+}
+
+QCPC_DECL_DEF(error_item) = one<'x'>;
+QCPC_DECL_DEF(error_items) = *recover(error_item, one<','>);
+QCPC_DECL_DEF(error_backtrack) = (error_items & one<';'>) | (error_items & eoi);
+
+TEST(Error, RecoverBacktrack) {
+    // Recoveries of an alternative which is backtracked are not reported twice.
+    StringInput in("xyx");
+    auto ret = parse(error_backtrack, in);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret.diagnostics().size(), 1);
+    ASSERT_EQ(ret.diagnostics()[0].message(), "1:1: expected 'x' or error_item");
+}
+
+QCPC_DECL_DEF(error_let) = QCPC_KEYWORD("let") & must(error_sep & error_field & one<'='>);
+QCPC_DECL_DEF(error_call) = error_field & one<'('> & one<')'>;
+QCPC_DECL_DEF(error_statement) = error_let | error_call;
+QCPC_DECL_DEF(error_statements) = *(recover(error_statement, one<';'>) & one<';'>) & eoi;
+
+TEST(Error, Must) {
+    // Without `must`, "let" would be tried as the name of a call.
+    StringInput in("let x(");
+    auto ret = parse(error_statement, in);
+    ASSERT_EQ(ret.status(), ParseStatus::Mismatch);
+    ASSERT_EQ(ret.error().message(), "1:5: expected [a-z] or '='");
+
+    StringInput in2("f();let 1;let y=;g(");
+    auto ret2 = parse(error_statements, in2);
+    ASSERT_FALSE(ret2);
+    ASSERT_EQ(ret2.error().message(), "1:19: expected ';'");
+
+    StringInput in3("f();let 1;let y=;g();");
+    auto ret3 = parse(error_statements, in3);
+    ASSERT_TRUE(ret3);
+    ASSERT_EQ(ret3->children.size(), 4);
+    ASSERT_EQ(ret3->children[1].tag(), ERROR_RULE);
+    ASSERT_EQ(ret3->children[1].view(), "let 1");
+    ASSERT_EQ(ret3.diagnostics().size(), 1);
+    ASSERT_EQ(ret3.diagnostics()[0].message(), "1:8: expected [ \\n], [a-z] or error_field");
+}
+
+QCPC_DECL_DEF(error_committed) =
+    *(recover((one<'a'> & must(one<'b'>)) | (one<'a'> & one<'c'>), one<';'>) & one<';'>) & eoi;
+
+TEST(Error, MustSkipsAlternatives) {
+    // After "a", `must` commits to the first alternative, even though the second one matches.
+    StringInput in("ac;ab;");
+    auto ret = parse(error_committed, in);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret->children.size(), 1);
+    ASSERT_EQ(ret->children[0].tag(), ERROR_RULE);
+    ASSERT_EQ(ret->children[0].view(), "ac");
+    ASSERT_EQ(ret.diagnostics().size(), 1);
+    ASSERT_EQ(ret.diagnostics()[0].message(), "1:1: expected 'b'");
+}
+
+TEST(Error, MustPrunesMemo) {
+    // Every matched `x` and `,` is memoized, but nothing before a `must` is looked up again.
+    auto memo_size = [](auto rule, const std::string& str) {
+        StringInput in(str);
+        ParseOptions opts;
+        detail::State st(opts, in.current());
+        Token::Children out;
+        EXPECT_TRUE(rule.parse(in, out, st));
+        return st.mem.size();
+    };
+    std::string input;
+    for (int i = 0; i < 100000; ++i) input += "x,";
+    ASSERT_GT(memo_size(*(one<'x'> & one<','>), input), 200000);
+    ASSERT_LT(memo_size(*(one<'x'> & must(one<','>)), input), 10000);
+}
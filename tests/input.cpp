@@ -1,3 +1,4 @@
+#include <cstdio>
 #include <string>
 
 #include "gtest/gtest.h"
@@ -39,3 +40,52 @@ TEST(Input, StringInput) {
     qcpc::StringInput in(test_cstr);
     test_helper(in);
 }
+
+TEST(Input, MmapInput) {
+    const char* path = "qcpc_mmap_input.txt";
+    std::FILE* file = std::fopen(path, "wb");
+    ASSERT_TRUE(file);
+    std::fputs(test_cstr, file);
+    std::fclose(file);
+
+    {
+        qcpc::MmapInput in(path);
+        ASSERT_TRUE(in.is_open());
+        test_helper(in);
+        ASSERT_EQ(*in, '\0');
+    }
+    std::remove(path);
+
+    qcpc::MmapInput missing("qcpc_no_such_file.txt");
+    ASSERT_FALSE(missing.is_open());
+    ASSERT_TRUE(missing.is_eoi());
+}
+
+TEST(Input, PaddedInput) {
+    qcpc::PaddedStringInput in(test_cstr);
+    test_helper(in, true);
+    for (size_t i = 0; i < qcpc::INPUT_PADDING; ++i) ASSERT_EQ(in.end()[i], '\0');
+
+    const std::string text = "abc";
+    qcpc::PaddedStringInput copy(text.data(), text.data() + 2);
+    ASSERT_EQ(copy.size(), 2);
+    ASSERT_NE(copy.begin(), text.data());
+    ASSERT_EQ(*copy.end(), '\0');
+
+    const char* path = "qcpc_padded_input.txt";
+    std::FILE* file = std::fopen(path, "wb");
+    ASSERT_TRUE(file);
+    std::fputs(test_cstr, file);
+    std::fclose(file);
+    {
+        qcpc::PaddedMmapInput mapped(path);
+        ASSERT_TRUE(mapped.is_open());
+        test_helper(mapped);
+        for (size_t i = 0; i < qcpc::INPUT_PADDING; ++i) ASSERT_EQ(mapped.end()[i], '\0');
+    }
+    std::remove(path);
+
+    qcpc::PaddedMmapInput missing("qcpc_no_such_file.txt");
+    ASSERT_FALSE(missing.is_open());
+    ASSERT_EQ(*missing.end(), '\0');
+}
@@ -0,0 +1,107 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "qcpc/lex/lex.hpp"
+#include "qcpc/qcpc.hpp"
+
+using namespace qcpc;
+
+namespace {
+
+// Named kinds stay below ' ', so that punctuation can use itself as kind.
+enum class Tok : char { Ident = 1, Number, String, KwInt, KwReturn, Le };
+
+// Kinds are stored as one byte, and wider ones would collide.
+enum class WideTok { Low = 0, High = 255, TooHigh = 256, Negative = -1 };
+static_assert(lex::detail::is_byte_kind<WideTok::Low>());
+static_assert(lex::detail::is_byte_kind<WideTok::High>());
+static_assert(!lex::detail::is_byte_kind<WideTok::TooHigh>());
+static_assert(!lex::detail::is_byte_kind<WideTok::Negative>());
+static_assert(lex::detail::is_byte_kind<'\xff'>());
+
+// clang-format off
+constexpr auto tok_lexer = lex::lexer(
+    one<' ', '\t', '\r', '\n'>,
+    lex::skip(QCPC_STR("//") & until_any(one<'\n'>)),
+    lex::skip(QCPC_STR("/*") & until<"*/">),
+    lex::define<Tok::KwInt>(QCPC_KEYWORD("int")),
+    lex::define<Tok::KwReturn>(QCPC_KEYWORD("return")),
+    lex::define<Tok::Ident>(ident),
+    lex::define<Tok::Number>(decimal),
+    lex::define<Tok::String>(quoted<'"', '"', '\\'>),
+    lex::define<Tok::Le>(QCPC_STR("<=")),
+    lex::define<'('>(one<'('>),
+    lex::define<')'>(one<')'>),
+    lex::define<'<'>(one<'<'>),
+    lex::define<'='>(one<'='>),
+    lex::define<';'>(one<';'>));
+// clang-format on
+
+}  // namespace
+
+QCPC_DECL_DEF(lex_word) = +one<'a', 'b'>;
+
+namespace {
+
+constexpr auto word_lexer = lex::lexer(one<' '>, lex::define<Tok::Ident>(lex_word));
+
+}  // namespace
+
+QCPC_DECL_DEF(lex_operand) = lex::kind<Tok::Ident> | lex::kind<Tok::Number>;
+QCPC_DECL_DEF(lex_cmp) = list(lex_operand, one<'<'> | lex::kind<Tok::Le>);
+QCPC_DECL_DEF(lex_decl) =
+    lex::kind<Tok::KwInt> & lex::kind<Tok::Ident> & one<'='> & lex_cmp & one<';'>;
+QCPC_DECL_DEF(lex_return) = lex::kind<Tok::KwReturn> & lex_cmp & one<';'>;
+QCPC_DECL_DEF(lex_program) = *(lex_decl | lex_return) & eoi;
+
+TEST(Lex, Tokenize) {
+    std::string src = "int x = a <= 10; // comment\n/* block\n */ return \"s\\\"\" < x;";
+    lex::TokenStream stream;
+    ASSERT_EQ(tok_lexer.tokenize(src.data(), src.data() + src.size(), stream),
+              src.data() + src.size());
+    ASSERT_EQ(stream.size(), 12);
+    ASSERT_EQ(stream.kind(0), static_cast<char>(Tok::KwInt));
+    ASSERT_EQ(stream.kind(1), static_cast<char>(Tok::Ident));
+    ASSERT_EQ(stream.kind(4), static_cast<char>(Tok::Le));
+    ASSERT_EQ(stream.text(5), "10");
+    ASSERT_EQ(stream.text(8), "\"s\\\"\"");
+    ASSERT_EQ(stream.lexeme(7).offset, src.find("return"));
+
+    std::string bad = "int x = 1 # 2;";
+    ASSERT_EQ(tok_lexer.tokenize(bad.data(), bad.data() + bad.size(), stream), bad.data() + 10);
+}
+
+TEST(Lex, ManyRuleLexemes) {
+    // Enough generated-rule entries to poll the parse options.
+    std::string src;
+    for (size_t i = 0; i < 5000; ++i) src += "ab ";
+    lex::TokenStream stream;
+    ASSERT_EQ(word_lexer.tokenize(src.data(), src.data() + src.size(), stream),
+              src.data() + src.size());
+    ASSERT_EQ(stream.size(), 5000);
+    ASSERT_EQ(stream.text(4999), "ab");
+}
+
+TEST(Lex, Parse) {
+    std::string src = "int x = a <= 10;\nreturn\n  b < x;";
+    lex::TokenStream stream;
+    ASSERT_EQ(tok_lexer.tokenize(src.data(), src.data() + src.size(), stream),
+              src.data() + src.size());
+    lex::TokenStreamInput in(stream);
+    auto ret = parse(lex_program, in);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret->children.size(), 2);
+    ASSERT_EQ(stream.text(ret->children[0]), "int x = a <= 10;");
+    ASSERT_EQ(stream.text(ret->children[1].children[0]), "b < x");
+    ASSERT_EQ(stream.source_pos(ret->children[1].begin()).line, 2);
+
+    std::string bad_src = "int x = a;\nreturn 1 < ;";
+    ASSERT_EQ(tok_lexer.tokenize(bad_src.data(), bad_src.data() + bad_src.size(), stream),
+              bad_src.data() + bad_src.size());
+    lex::TokenStreamInput bad(stream);
+    auto err = parse(lex_program, bad);
+    ASSERT_FALSE(err);
+    ParseError error = err.error();
+    stream.locate(error);
+    ASSERT_EQ(error.message(), "2:11: expected Ident, Number or lex_operand");
+}
@@ -0,0 +1,88 @@
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "qcpc/qcpc.hpp"
+
+using namespace qcpc;
+
+QCPC_DECL_DEF(number_int) = integer<int32_t> & eoi;
+QCPC_DECL_DEF(number_u64) = decimal & eoi;
+QCPC_DECL_DEF(number_hex) = QCPC_STR("0x") & hex & eoi;
+QCPC_DECL_DEF(number_float) = floating;
+
+template<class Rule>
+bool matches(Rule rule, std::string_view str) {
+    MemoryInput in(str.data(), str.data() + str.size());
+    return bool(parse(rule, in));
+}
+
+TEST(Number, Integer) {
+    ASSERT_TRUE(matches(number_int, "0"));
+    ASSERT_TRUE(matches(number_int, "-2147483648"));
+    ASSERT_TRUE(matches(number_int, "2147483647"));
+    ASSERT_TRUE(matches(number_int, "0000000000000000000000002147483647"));
+    ASSERT_FALSE(matches(number_int, "2147483648"));
+    ASSERT_FALSE(matches(number_int, "-2147483649"));
+    ASSERT_FALSE(matches(number_int, "-"));
+    ASSERT_FALSE(matches(number_int, "+1"));
+
+    ASSERT_TRUE(matches(number_u64, "18446744073709551615"));
+    ASSERT_FALSE(matches(number_u64, "18446744073709551616"));
+    ASSERT_FALSE(matches(number_u64, "100000000000000000000"));
+    ASSERT_FALSE(matches(number_u64, "-1"));
+
+    ASSERT_EQ(integer<int32_t>.value("-2147483648"), std::numeric_limits<int32_t>::min());
+    ASSERT_EQ(integer<int64_t>.value("-9223372036854775808"),
+              std::numeric_limits<int64_t>::min());
+    ASSERT_EQ(integer<int>.value("1234567890"), 1234567890);
+    ASSERT_EQ(decimal.value("18446744073709551615"), std::numeric_limits<uint64_t>::max());
+    ASSERT_EQ(decimal.value("000000000000000000042"), 42);
+    // Only whole matches have a value.
+    ASSERT_EQ(integer<int>.value(""), std::nullopt);
+    ASSERT_EQ(integer<int>.value("-"), std::nullopt);
+    ASSERT_EQ(integer<int>.value("12a"), std::nullopt);
+    ASSERT_EQ(integer<int>.value("2147483648"), std::nullopt);
+    ASSERT_EQ(decimal.value("-1"), std::nullopt);
+}
+
+TEST(Number, Hex) {
+    ASSERT_TRUE(matches(number_hex, "0xffffffffffffffff"));
+    ASSERT_TRUE(matches(number_hex, "0x0000ffffffffffffffff"));
+    ASSERT_FALSE(matches(number_hex, "0x1ffffffffffffffff"));
+    ASSERT_FALSE(matches(number_hex, "0x"));
+    ASSERT_EQ(hex.value("DeadBeef"), 0xdeadbeef);
+    ASSERT_EQ(hex.value("0000ffffffffffffffff"), std::numeric_limits<uint64_t>::max());
+    ASSERT_EQ(hex.value(""), std::nullopt);
+    ASSERT_EQ(hex.value("1ffffffffffffffff"), std::nullopt);
+    ASSERT_EQ(hex.value("0x1"), std::nullopt);
+}
+
+TEST(Number, Floating) {
+    auto match = [](std::string_view str) {
+        MemoryInput in(str.data(), str.data() + str.size());
+        auto ret = parse(number_float, in);
+        return ret ? std::string(ret->view()) : "<fail>";
+    };
+    ASSERT_EQ(match("1.5e3x"), "1.5e3");
+    ASSERT_EQ(match("-0.25"), "-0.25");
+    ASSERT_EQ(match("7.e5"), "7");
+    ASSERT_EQ(match("7e+"), "7");
+    ASSERT_EQ(match(".5"), "<fail>");
+
+    ASSERT_EQ(floating.value("1.5e3"), 1500.0);
+    ASSERT_EQ(floating.value("-0.1"), -0.1);
+    ASSERT_EQ(floating.value("123456789012345678901234567890"), 1.2345678901234568e29);
+    ASSERT_EQ(floating.value("1e400"), std::numeric_limits<double>::infinity());
+    ASSERT_EQ(floating.value("-1e400"), -std::numeric_limits<double>::infinity());
+    ASSERT_EQ(floating.value("1e-400"), 0.0);
+    ASSERT_EQ(floating.value("0.00001e-400"), 0.0);
+    ASSERT_EQ(floating.value("100000e-5000"), 0.0);
+    ASSERT_EQ(floating.value(""), std::nullopt);
+    ASSERT_EQ(floating.value("1e"), std::nullopt);
+    ASSERT_EQ(floating.value("1e+"), std::nullopt);
+    ASSERT_EQ(floating.value(".5"), std::nullopt);
+}
@@ -0,0 +1,60 @@
+#include <array>
+#include <type_traits>
+
+#include "gtest/gtest.h"
+// Profiles are looked up once they may exist, like after including a profile header.
+#define QCPC_PROFILE_DATA
+#include "qcpc/qcpc.hpp"
+
+using namespace qcpc;
+
+QCPC_DECL_DEF(profile_word) = +range<'a', 'z'>;
+QCPC_DECL_DEF(profile_number) = -one<'-'> & +range<'0', '9'>;
+QCPC_DECL_DEF(profile_string) = one<'"'> & *range<'a', 'z'> & one<'"'>;
+QCPC_DECL_DEF(profile_null) = QCPC_STR("null");
+
+using ProfiledChoice = decltype(profile_word | profile_number | profile_string);
+
+// Like a header written by `profile::save`, it comes before any use of the choice.
+template<>
+inline constexpr detail::SorHits detail::sor_profile<detail::rule_tag<ProfiledChoice>()> = {
+    3,
+    {1, 5, 3},
+};
+
+QCPC_DECL_DEF(profile_values) = list(ProfiledChoice{}, one<','>) & eoi;
+
+TEST(Profile, Disjoint) {
+    using Word = std::remove_cvref_t<decltype(profile_word)>;
+    using Number = std::remove_cvref_t<decltype(profile_number)>;
+    using Null = std::remove_cvref_t<decltype(profile_null)>;
+    static_assert(detail::FirstChars<Number>::chars['-']);
+    static_assert(detail::FirstChars<Number>::chars['7']);
+    static_assert(detail::disjoint<Word, Number>());
+    // Both may begin with 'n'.
+    static_assert(!detail::disjoint<Word, Null>());
+    // `*` matches empty input.
+    static_assert(!detail::disjoint<Word, decltype(*one<'0'>)>());
+    static_assert(!detail::disjoint<Word, decltype(QCPC_STR(""))>());
+    static_assert(!detail::disjoint<Word, decltype(QCPC_STR("") & one<'0'>)>());
+}
+
+TEST(Profile, Order) {
+    static_assert(detail::SorOrder<ProfiledChoice>::value == std::array<size_t, 3>{1, 2, 0});
+    using Unprofiled = decltype(profile_string | profile_word);
+    static_assert(detail::SorOrder<Unprofiled>::value == std::array<size_t, 2>{0, 1});
+
+    // Reordering does not change matches.
+    StringInput in(R"(abc,-12,"xy",7)");
+    auto ret = parse(profile_values, in);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret->children.size(), 4);
+    ASSERT_EQ(ret->children[0].tag(), profile_word.tag);
+    ASSERT_EQ(ret->children[1].tag(), profile_number.tag);
+    ASSERT_EQ(ret->children[1].view(), "-12");
+    ASSERT_EQ(ret->children[2].tag(), profile_string.tag);
+    ASSERT_EQ(ret->children[3].tag(), profile_number.tag);
+
+    StringInput bad("abc,?");
+    ASSERT_FALSE(parse(profile_values, bad));
+}
@@ -0,0 +1,48 @@
+#include <array>
+
+#include "gtest/gtest.h"
+#include "qcpc/qcpc.hpp"
+
+using namespace qcpc;
+
+QCPC_DECL_DEF(idx_a) = one<'a'>;
+QCPC_DECL_DEF(idx_b) = one<'b'>;
+QCPC_DECL_DEF(idx_c) = one<'c'>;
+QCPC_DECL_DEF_(idx_sep) = *one<' '>;
+QCPC_DECL_DEF(idx_list) = list(idx_a | idx_b | idx_c, idx_sep);
+
+using Index = RuleIndex<idx_list, idx_a, idx_b, idx_c>;
+
+TEST(RuleIndex, Ids) {
+    static_assert(Index::size == 4);
+    static_assert(Index::id<idx_list> == 0);
+    static_assert(Index::id<idx_a> == 1);
+    static_assert(Index::id<idx_b> == 2);
+    static_assert(Index::id<idx_c> == 3);
+    static_assert(Index::of(idx_b.tag) == 2);
+    static_assert(Index::names[3] == "idx_c");
+
+    for (size_t i = 0; i < Index::size; ++i) ASSERT_EQ(Index::of(Index::tags[i]), i);
+    ASSERT_EQ(Index::of(NO_RULE), Index::size);
+    ASSERT_EQ(Index::of(RuleTag{12345}), Index::size);
+}
+
+TEST(RuleIndex, Dispatch) {
+    StringInput in("a b c b");
+    auto ret = parse(idx_list, in);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(Index::of(*ret), Index::id<idx_list>);
+
+    std::array<size_t, Index::size> counts{};
+    for (const auto& child: ret->children) {
+        switch (Index::of(child)) {
+        case Index::id<idx_a>:
+        case Index::id<idx_b>:
+        case Index::id<idx_c>: counts[Index::of(child)] += 1; break;
+        default: FAIL();
+        }
+    }
+    ASSERT_EQ(counts[Index::id<idx_a>], 1);
+    ASSERT_EQ(counts[Index::id<idx_b>], 2);
+    ASSERT_EQ(counts[Index::id<idx_c>], 1);
+}
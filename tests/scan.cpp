@@ -0,0 +1,121 @@
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "qcpc/qcpc.hpp"
+
+using namespace qcpc;
+
+QCPC_DECL_DEF(scan_octet) = integer<uint8_t>;
+QCPC_DECL_DEF(scan_ip) = scan_octet & one<'.'> & scan_octet & one<'.'> & scan_octet & one<'.'> &
+                         scan_octet & !range<'0', '9'>;
+QCPC_DECL_DEF(scan_key) = +range<'a', 'z'>;
+QCPC_DECL_DEF(scan_pair) = scan_key & one<'='> & (quoted<'"', '"'> | +range<'0', '9'>);
+QCPC_DECL_DEF(scan_any_pair) = *one<' '> & scan_pair;
+
+namespace {
+
+struct Match {
+    std::string text;
+    size_t line;
+    size_t column;
+
+    bool operator==(const Match&) const = default;
+};
+
+template<class Rule>
+std::vector<Match> scan_all(Rule rule, const std::string& text) {
+    StringInput in(text);
+    std::vector<Match> ret;
+    auto result = scan(rule, in, [&ret](Token&& token) {
+        ret.push_back({std::string(token.view()), token.line(), token.column()});
+    });
+    EXPECT_EQ(result.matches, ret.size());
+    EXPECT_EQ(result.reason, AbortReason::None);
+    return ret;
+}
+
+template<class Rule>
+std::vector<Match> scan_all_parallel(Rule rule,
+                                     const std::string& text,
+                                     size_t threads,
+                                     const ParseOptions& opts = {}) {
+    std::vector<Match> ret;
+    auto result = scan_parallel(
+        rule, text,
+        [&ret](Token&& token) {
+            ret.push_back({std::string(token.view()), token.line(), token.column()});
+        },
+        threads, opts);
+    EXPECT_EQ(result.matches, ret.size());
+    return ret;
+}
+
+}  // namespace
+
+TEST(Scan, Scan) {
+    auto ips = scan_all(scan_ip, "from 10.0.0.1 to 300.1.1.1,\n192.168.1.255 and 1.2.3.4.5 1.2.3");
+    // Like `grep`, matches may begin in the middle of words.
+    ASSERT_EQ(ips, (std::vector<Match>{{"10.0.0.1", 1, 5},
+                                       {"00.1.1.1", 1, 18},
+                                       {"192.168.1.255", 2, 0},
+                                       {"1.2.3.4", 2, 18}}));
+
+    // Matches do not overlap, the search resumes at their end.
+    auto pairs = scan_all(scan_pair, "a=1 b=\"x c=2\" d=e=3 ==4");
+    ASSERT_EQ(pairs, (std::vector<Match>{{"a=1", 1, 0}, {"b=\"x c=2\"", 1, 4}, {"e=3", 1, 16}}));
+
+    // Rules whose first characters are not known are tried everywhere.
+    pairs = scan_all(scan_any_pair, "x  y=1");
+    ASSERT_EQ(pairs, (std::vector<Match>{{"  y=1", 1, 1}}));
+
+    StringInput in("a=1 b=2 c=3");
+    size_t count = 0;
+    auto result = scan(scan_pair, in, [&count](Token&&) { return ++count < 2; });
+    ASSERT_EQ(result.matches, 2);
+}
+
+TEST(Scan, Parallel) {
+    // Quoted values make matches depend on where the scan starts, so threads beginning inside
+    // them disagree with a sequential scan until they are synchronized.
+    std::string text;
+    for (size_t i = 0; text.size() < 200000; ++i) {
+        text += 'k';
+        text.append(i % 7, 'x');
+        text += '=';
+        if (i % 3 == 0) {
+            text += "\"v a=";
+            text += std::to_string(i);
+            text.append(i % 5000, ' ');
+            text += '"';
+        } else {
+            text += std::to_string(i);
+        }
+        text += i % 11 == 0 ? '\n' : ' ';
+    }
+    auto expected = scan_all(scan_pair, text);
+    ASSERT_GT(expected.size(), 100);
+    for (size_t threads: {1, 2, 3, 8, 13}) {
+        ASSERT_EQ(scan_all_parallel(scan_pair, text, threads), expected) << threads;
+    }
+}
+
+TEST(Scan, ParallelArena) {
+    // Threads would race on a shared arena, so it is left alone.
+    struct CountingArena: std::pmr::monotonic_buffer_resource {
+        size_t allocations = 0;
+
+      private:
+        void* do_allocate(size_t bytes, size_t align) override {
+            allocations += 1;
+            return monotonic_buffer_resource::do_allocate(bytes, align);
+        }
+    } arena;
+    std::string text;
+    for (size_t i = 0; i < 20000; ++i) text += "k=" + std::to_string(i) + ' ';
+    auto matches = scan_all_parallel(scan_pair, text, 8, {.memory_resource = &arena});
+    ASSERT_EQ(matches, scan_all(scan_pair, text));
+    ASSERT_EQ(matches.size(), 20000);
+    ASSERT_EQ(arena.allocations, 0);
+}
@@ -0,0 +1,98 @@
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "qcpc/qcpc.hpp"
+#include "qcpc/vm/vm.hpp"
+
+using namespace qcpc;
+
+QCPC_DECL_DEF(seg_string) = quoted<'"', '"', '\\'>;
+QCPC_DECL_DEF(seg_comment) = QCPC_STR("/*") & until<"*/">;
+QCPC_DECL_DEF(seg_number) = floating;
+QCPC_DECL_DEF(seg_count) = integer<int>;
+QCPC_DECL_DEF(seg_word) = QCPC_STR("key") | QCPC_STR("value");
+QCPC_DECL_DEF(seg_item) = seg_string | seg_comment | (seg_count & one<'#'>) | seg_number | seg_word;
+QCPC_DECL_DEF(seg_line) = list(seg_item, one<' '>) & until_any(one<'\n'>) & eol;
+QCPC_DECL_DEF(seg_file) = *seg_line & eoi;
+
+namespace {
+
+void collect(const SegmentedInput& in, const Token& token, std::vector<std::string>& out) {
+    out.push_back(in.text(token));
+    for (const auto& child: token.children) collect(in, child, out);
+}
+
+}  // namespace
+
+TEST(Segmented, Splits) {
+    const std::string source =
+        "key \"a \\\"b\\\" c\" -12.5e3\n"
+        "/* x * y */ value 42# key\n";
+    SegmentedInput whole({source});
+    auto expected = parse(seg_file, whole);
+    ASSERT_TRUE(expected);
+    std::vector<std::string> expected_texts;
+    collect(whole, *expected, expected_texts);
+
+    // Every way to cut the source into three segments matches the same tokens.
+    std::string_view view = source;
+    for (size_t i = 0; i <= source.size(); ++i) {
+        for (size_t j = i; j <= source.size(); ++j) {
+            SegmentedInput in({view.substr(0, i), view.substr(i, j - i), view.substr(j)});
+            auto ret = parse(seg_file, in);
+            ASSERT_TRUE(ret) << i << " " << j;
+            std::vector<std::string> texts;
+            collect(in, *ret, texts);
+            ASSERT_EQ(texts, expected_texts) << i << " " << j;
+            ASSERT_EQ(ret->children[1].line(), 2);
+        }
+    }
+}
+
+TEST(Segmented, Errors) {
+    const std::string source = "key 1\n\"unterminated";
+    std::string_view view = source;
+    for (size_t i = 0; i <= source.size(); ++i) {
+        SegmentedInput in({view.substr(0, i), view.substr(i)});
+        auto ret = parse(seg_file, in);
+        ASSERT_FALSE(ret);
+        ASSERT_EQ(ret.error().message(), "2:13: expected '\"'") << i;
+    }
+}
+
+TEST(Segmented, Input) {
+    const std::string source = "abcdefgh";
+    std::string_view view = source;
+    SegmentedInput in({view.substr(0, 3), view.substr(3, 0), view.substr(3)});
+    ASSERT_EQ(in.size(), 8);
+    ASSERT_EQ(in.end(), source.data() + 3);
+    ASSERT_EQ(in[4], 'e');
+    ASSERT_EQ(std::string_view(in.contiguous(5), 5), "abcde");
+    in.advance(3);
+    ASSERT_EQ(in.current(), source.data() + 3);
+    ASSERT_EQ(in.end(), source.data() + 8);
+    ASSERT_EQ(in.contiguous(6), nullptr);
+
+    // Segments out of address order are concatenated.
+    SegmentedInput swapped({view.substr(4), view.substr(0, 4)});
+    ASSERT_EQ(swapped.size(), 8);
+    ASSERT_EQ(std::string_view(swapped.contiguous(8), 8), "efghabcd");
+    ASSERT_NE(swapped.current(), source.data() + 4);
+}
+
+TEST(Segmented, VM) {
+    std::string error;
+    auto prog = vm::compile("pair <- 'key' '=' [0-9]+ !.", &error);
+    ASSERT_TRUE(prog) << error;
+
+    const std::string source = "key=123";
+    std::string_view view = source;
+    for (size_t i = 0; i <= source.size(); ++i) {
+        SegmentedInput in({view.substr(0, i), view.substr(i)});
+        ASSERT_TRUE(vm::parse(*prog, in)) << i;
+    }
+    SegmentedInput bad({view.substr(0, 2), view.substr(2, 2)});
+    ASSERT_EQ(vm::parse(*prog, bad).error().message(), "1:4: expected [0-9]");
+}
@@ -68,6 +68,18 @@ TEST(SimpleRule, One) {
     ASSERT_EQ(in2.current(), in2.begin());
 }
 
+QCPC_DECL_DEF(any_rule) = any;
+
+TEST(SimpleRule, Any) {
+    StringInput in1("\n");
+    ASSERT_TRUE(parse(any_rule, in1));
+    ASSERT_EQ(in1.current(), in1.end());
+
+    StringInput in2("");
+    ASSERT_FALSE(parse(any_rule, in2));
+    ASSERT_EQ(in2.current(), in2.begin());
+}
+
 QCPC_DECL_DEF(str_rule) = str<'q', 'c', 'p', 'c'>;
 QCPC_DECL_DEF(macro_str_rule) = QCPC_STR("qcpc");
 
@@ -238,3 +250,25 @@ TEST(SimpleRule, Sor) {
     ASSERT_FALSE(parse(sor_rule4, in2));
     ASSERT_EQ(in2.current(), in2.begin());
 }
+
+QCPC_DECL_DEF(padded_item) = QCPC_STR("qcpc") | quoted<'"', '"', '\\'> | floating |
+                             (one<'a', 'b'> & range<'0', '9', '_'>) | one<'\0'>;
+QCPC_DECL_DEF(padded_rule) = *(padded_item & until_any(one<'\n', ';'>) & (eol | one<';'>));
+
+TEST(SimpleRule, Padded) {
+    // Padded inputs skip checks for the end of input, and must match like others.
+    const char* texts[] = {"", "qcpc;", "qcp", "\"abc", "\"a\\\"\n\";",
+                           "-1.5e", "a5;b_\n", "a", "1\r\n", "1\r",
+                           "\"a string longer than sixteen bytes\" rest;"};
+    for (std::string text: texts) {
+        StringInput in1(text);
+        PaddedStringInput in2(text);
+        auto ret1 = parse(padded_rule, in1);
+        auto ret2 = parse(padded_rule, in2);
+        ASSERT_EQ(ret2->end() - in2.begin(), ret1->end() - in1.begin()) << text;
+        ASSERT_EQ(ret2->children.size(), ret1->children.size()) << text;
+    }
+    std::string nul("a1;\0;", 5);
+    PaddedStringInput in(nul);
+    ASSERT_EQ(parse(padded_rule, in)->view(), nul);
+}
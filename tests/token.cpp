@@ -1,7 +1,13 @@
+#include <array>
 #include <memory>
+#include <memory_resource>
+#include <string>
 
 #include "gtest/gtest.h"
 #include "qcpc/qcpc.hpp"
+#include "qcpc/vm/vm.hpp"
+
+using namespace qcpc;
 
 TEST(Token, Iter) {
     const char cstr[] = "Handsome QC";
@@ -12,3 +18,102 @@ TEST(Token, Iter) {
     for (auto c: root) ASSERT_EQ(c, cstr[count++]);
     ASSERT_EQ(count, sizeof(cstr) - 1);
 }
+
+QCPC_DECL(token_list);
+QCPC_DECL_DEF(token_item) = range<'0', '9'> | token_list;
+QCPC_DEF(token_list) = one<'('> & *token_item & one<')'>;
+QCPC_DECL_DEF(token_lists) = *(recover(token_list, one<';'>) & one<';'>) & eoi;
+
+namespace {
+
+/// Count allocations passed to another resource.
+struct CountingResource: std::pmr::memory_resource {
+    std::pmr::memory_resource* upstream;
+    size_t allocations = 0;
+
+    explicit CountingResource(std::pmr::memory_resource* upstream): upstream(upstream) {}
+
+  private:
+    void* do_allocate(size_t bytes, size_t align) override {
+        allocations += 1;
+        return upstream->allocate(bytes, align);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t align) override {
+        upstream->deallocate(ptr, bytes, align);
+    }
+
+    [[nodiscard]] bool do_is_equal(const memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/// Check every children vector of `token` uses `resource`.
+bool uses(const Token& token, std::pmr::memory_resource* resource) {
+    if (token.children.get_allocator().resource() != resource) return false;
+    for (const auto& child: token.children) {
+        if (!uses(child, resource)) return false;
+    }
+    return true;
+}
+
+/// Fail every allocation from the default resource while alive.
+struct NoDefaultResource {
+    std::pmr::memory_resource* old =
+        std::pmr::set_default_resource(std::pmr::null_memory_resource());
+
+    ~NoDefaultResource() {
+        std::pmr::set_default_resource(this->old);
+    }
+};
+
+}  // namespace
+
+TEST(Token, MemoryResource) {
+    std::array<std::byte, 4096> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+    CountingResource counting(&arena);
+    StringInput in("(1(23)(4(5)))");
+    {
+        NoDefaultResource guard;
+        auto ret = parse(token_list, in, {.memory_resource = &counting});
+        ASSERT_TRUE(ret);
+        ASSERT_EQ(ret->children.size(), 3);
+        ASSERT_TRUE(uses(*ret, &counting));
+    }
+    ASSERT_GT(counting.allocations, 0);
+
+    // Error tokens of recovered failures as well.
+    StringInput bad_in("(1);(x;(2);");
+    {
+        NoDefaultResource guard;
+        auto ret = parse(token_lists, bad_in, {.memory_resource = &counting});
+        ASSERT_TRUE(ret);
+        ASSERT_EQ(ret->children[1].tag(), ERROR_RULE);
+        ASSERT_TRUE(uses(*ret, &counting));
+    }
+
+    auto prog = vm::compile(R"(
+        list <- '(' item* ')'
+        item <- [0-9] / list
+    )");
+    ASSERT_TRUE(prog);
+    StringInput vm_in("(1(23)(4(5)))");
+    {
+        NoDefaultResource guard;
+        auto ret = vm::parse(*prog, vm_in, {.memory_resource = &counting});
+        ASSERT_TRUE(ret);
+        ASSERT_TRUE(uses(*ret, &counting));
+    }
+
+    // Parses without a resource use the default resource.
+    {
+        CountingResource fallback(std::pmr::new_delete_resource());
+        std::pmr::memory_resource* old = std::pmr::set_default_resource(&fallback);
+        StringInput heap_in("(1(23))");
+        auto ret = parse(token_list, heap_in);
+        std::pmr::set_default_resource(old);
+        ASSERT_TRUE(ret);
+        ASSERT_TRUE(uses(*ret, &fallback));
+    }
+}
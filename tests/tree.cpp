@@ -0,0 +1,92 @@
+#include <cstdio>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "qcpc/qcpc.hpp"
+#include "qcpc/tree/tree.hpp"
+
+using namespace qcpc;
+
+QCPC_DECL_DEF(tree_number) = +range<'0', '9'>;
+QCPC_DECL_DEF_(tree_sep) = *one<' ', '\n'>;
+QCPC_DECL(tree_list);
+QCPC_DECL_DEF(tree_item) = tree_number | (one<'('> & tree_list & one<')'>);
+QCPC_DEF(tree_list) = tree_sep & *(tree_item & tree_sep);
+QCPC_DECL_DEF(tree_file) = tree_list & eoi;
+
+namespace {
+
+void expect_same(const Token& token, const tree::NodeView& node) {
+    ASSERT_EQ(node.tag(), token.tag());
+    ASSERT_EQ(node.view(), token.view());
+    ASSERT_EQ(node.line(), token.line());
+    ASSERT_EQ(node.column(), token.column());
+    ASSERT_EQ(node.children.size(), token.children.size());
+    size_t i = 0;
+    for (auto child: node.children) expect_same(token.children[i++], child);
+}
+
+}  // namespace
+
+TEST(Tree, Serialize) {
+    StringInput in("1 (2 (3 4)\n()) 56");
+    auto ret = parse(tree_file, in);
+    ASSERT_TRUE(ret);
+    std::string_view source(in.begin(), in.end() - in.begin());
+
+    std::string bytes = tree::serialize(*ret, source);
+    tree::TreeView view(bytes);
+    ASSERT_TRUE(view.is_valid());
+    ASSERT_TRUE(view.validate());
+    ASSERT_TRUE(view.has_embedded_source());
+    ASSERT_EQ(view.source(), source);
+    ASSERT_NE(view.source().data(), source.data());
+    expect_same(*ret, view.root());
+    ASSERT_EQ(view.root().children[0].children[2].children[0].view(), "56");
+
+    // Without the source text, readers must give the same one.
+    bytes = tree::serialize(*ret, source, false);
+    ASSERT_FALSE(tree::TreeView(bytes, "1 (2").is_valid());
+    tree::TreeView referenced(bytes, source);
+    ASSERT_TRUE(referenced.validate());
+    ASSERT_FALSE(referenced.has_embedded_source());
+    ASSERT_EQ(referenced.root().begin(), source.data());
+    expect_same(*ret, referenced.root());
+}
+
+TEST(Tree, Invalid) {
+    StringInput in("1 2");
+    auto ret = parse(tree_file, in);
+    ASSERT_TRUE(ret);
+    std::string bytes = tree::serialize(*ret, {in.begin(), 3});
+
+    ASSERT_FALSE(tree::TreeView("").is_valid());
+    ASSERT_FALSE(tree::TreeView(std::string_view(bytes).substr(0, bytes.size() - 1)).is_valid());
+    std::string corrupted = bytes;
+    corrupted[0] = 'X';
+    ASSERT_FALSE(tree::TreeView(corrupted).is_valid());
+
+    // The first child of the root, right after the header and tag table.
+    corrupted = bytes;
+    size_t tags = static_cast<unsigned char>(bytes[16 + 8]);
+    corrupted[64 + 8 * tags + 48 + 32] = 9;
+    tree::TreeView view(corrupted);
+    ASSERT_TRUE(view.is_valid());
+    ASSERT_FALSE(view.validate());
+}
+
+TEST(Tree, File) {
+    const char* path = "qcpc_tree_file.bin";
+    StringInput in("(1 2) 3");
+    auto ret = parse(tree_file, in);
+    ASSERT_TRUE(ret);
+    ASSERT_TRUE(tree::save(path, *ret, {in.begin(), 7}));
+    {
+        tree::TreeFile file(path);
+        ASSERT_TRUE(file.validate());
+        expect_same(*ret, file.root());
+    }
+    std::remove(path);
+
+    ASSERT_FALSE(tree::TreeFile("qcpc_no_such_file.bin").is_valid());
+}
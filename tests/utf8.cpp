@@ -0,0 +1,83 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "qcpc/qcpc.hpp"
+
+using namespace qcpc;
+
+QCPC_DECL_DEF(utf8_name) = utf8::ident;
+QCPC_DECL_DEF(utf8_greek) = +utf8::range<U'α', U'ω'> & utf8::one<U'!', U'。'> & eoi;
+
+template<class Input>
+bool match(auto rule, Input& in) {
+    Token::Children out;
+    detail::State st({}, in.current());
+    return rule.parse(in, out, st);
+}
+
+TEST(Utf8, Validate) {
+    auto valid = [](std::string_view str) {
+        return utf8::validate(str.data(), str.data() + str.size()) == str.data() + str.size();
+    };
+    ASSERT_TRUE(valid(""));
+    ASSERT_TRUE(valid("plain ASCII text which is longer than sixteen bytes"));
+    ASSERT_TRUE(valid("é中\U0001f600 and more text after the four byte sequence"));
+    ASSERT_TRUE(valid("\xf4\x8f\xbf\xbf"));
+    ASSERT_FALSE(valid("\x80"));
+    ASSERT_FALSE(valid("\xc0\xaf"));          // overlong
+    ASSERT_FALSE(valid("\xe0\x80\xaf"));      // overlong
+    ASSERT_FALSE(valid("\xed\xa0\x80"));      // surrogate
+    ASSERT_FALSE(valid("\xf4\x90\x80\x80"));  // above U+10FFFF
+    ASSERT_FALSE(valid("\xe4\xb8"));          // truncated
+
+    std::string str = std::string(40, 'a') + "\xff" + "b";
+    ASSERT_EQ(utf8::validate(str.data(), str.data() + str.size()), str.data() + 40);
+}
+
+TEST(Utf8, Rules) {
+    StringInput in1("αβγ。");
+    ASSERT_TRUE(parse(utf8_greek, in1));
+
+    StringInput in2("αβ?");
+    auto ret = parse(utf8_greek, in2);
+    ASSERT_FALSE(ret);
+    ASSERT_EQ(ret.error().message(), "1:4: expected [α-ω] or [!。]");
+
+    // Invalid sequences never match.
+    StringInput in3("\xce");
+    ASSERT_FALSE(match(utf8::any, in3));
+    StringInput in4("\xe4\xb8\xad");
+    ASSERT_TRUE(match(utf8::any, in4));
+    ASSERT_TRUE(in4.is_eoi());
+}
+
+TEST(Utf8, Identifiers) {
+    StringInput in1("变量_1 x");
+    auto ret = parse(utf8_name, in1);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret->view(), "变量_1");
+
+    StringInput in2("_ñ");
+    ASSERT_EQ(parse(utf8_name, in2)->view(), "_ñ");
+
+    StringInput in3("1a");
+    ASSERT_FALSE(parse(utf8_name, in3));
+    StringInput in4("·");  // MIDDLE DOT continues but does not start identifiers
+    ASSERT_FALSE(parse(utf8_name, in4));
+    StringInput in5("a·");
+    ASSERT_EQ(parse(utf8_name, in5)->view(), "a·");
+}
+
+TEST(Utf8, Columns) {
+    std::string str = "αβ\nγδ x";
+    Utf8Input in(str.data(), str.data() + str.size());
+    ASSERT_TRUE(match(utf8::any, in));
+    ASSERT_EQ(in.column(), 1);
+    in.advance_to(str.data() + str.size() - 1);
+    ASSERT_EQ(in.line(), 2);
+    ASSERT_EQ(in.column(), 3);
+
+    Utf8Input in2(str.data(), str.data() + str.size());
+    auto ret = parse(utf8_greek, in2);
+    ASSERT_EQ(ret.error().message(), "1:2: expected [α-ω] or [!。]");
+}
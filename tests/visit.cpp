@@ -0,0 +1,126 @@
+#include <atomic>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "qcpc/qcpc.hpp"
+
+using namespace qcpc;
+
+QCPC_DECL_DEF(visit_num) = +range<'0', '9'>;
+QCPC_DECL_DEF(visit_product) = list(visit_num, one<'*'>);
+QCPC_DECL_DEF(visit_sum) = list(visit_product, one<'+'>) & eoi;
+
+using VisitRules = RuleIndex<visit_num, visit_product, visit_sum>;
+
+TEST(Visit, Order) {
+    StringInput in("1*2+3");
+    auto ret = parse(visit_sum, in);
+    ASSERT_TRUE(ret);
+
+    std::vector<std::string_view> pre;
+    for (const Token& token: preorder(*ret)) pre.push_back(token.view());
+    ASSERT_EQ(pre, (std::vector<std::string_view>{"1*2+3", "1*2", "1", "2", "3", "3"}));
+
+    std::vector<std::string_view> post;
+    for (const Token& token: postorder(*ret)) post.push_back(token.view());
+    ASSERT_EQ(post, (std::vector<std::string_view>{"1", "2", "1*2", "3", "3", "1*2+3"}));
+}
+
+TEST(Visit, Dispatch) {
+    StringInput in("1*2+3");
+    auto ret = parse(visit_sum, in);
+    ASSERT_TRUE(ret);
+
+    std::vector<size_t> ids;
+    visit<VisitRules>(*ret, [&](auto id, const Token& token) {
+        static_assert(id <= VisitRules::size);
+        ASSERT_EQ(VisitRules::of(token), id);
+        ids.push_back(id);
+    });
+    ASSERT_EQ(ids, (std::vector<size_t>{2, 1, 0, 0, 1, 0}));
+
+    Token unknown({}, {in.pos(), in.current()});
+    ASSERT_EQ(dispatch<VisitRules>(unknown, [](auto id, const Token&) { return id(); }),
+              VisitRules::size);
+}
+
+TEST(Visit, Fold) {
+    StringInput in("2*3+4*5*6+7");
+    auto ret = parse(visit_sum, in);
+    ASSERT_TRUE(ret);
+    auto eval = [](auto id, const Token& token, std::span<long> values) {
+        if constexpr (id == VisitRules::id<visit_num>) {
+            return std::stol(std::string(token.view()));
+        } else if constexpr (id == VisitRules::id<visit_product>) {
+            long product = 1;
+            for (long v: values) product *= v;
+            return product;
+        } else {
+            long sum = 0;
+            for (long v: values) sum += v;
+            return sum;
+        }
+    };
+    ASSERT_EQ((fold<VisitRules, long>(*ret, eval)), 2 * 3 + 4 * 5 * 6 + 7);
+}
+
+TEST(Visit, Deep) {
+    // Far deeper than recursion on the native stack could go.
+    constexpr size_t depth = 200000;
+    const char text[] = "x";
+    InputPos pos{text, 1, 0};
+    Token root({}, {pos, text + 1});
+    for (size_t i = 1; i < depth; ++i) {
+        Token::Children children;
+        children.push_back(std::move(root));
+        root = Token(std::move(children), {pos, text + 1});
+    }
+
+    size_t count = 0;
+    for ([[maybe_unused]] const Token& token: preorder(root)) count += 1;
+    ASSERT_EQ(count, depth);
+    count = 0;
+    for ([[maybe_unused]] const Token& token: postorder(root)) count += 1;
+    ASSERT_EQ(count, depth);
+
+    auto height = fold<VisitRules, size_t>(root, [](auto, const Token&, std::span<size_t> values) {
+        return values.empty() ? size_t(1) : values[0] + 1;
+    });
+    ASSERT_EQ(height, depth);
+}
+
+QCPC_DECL_DEF(visit_record) = list(visit_num, one<','>) & one<'\n'>;
+QCPC_DECL_DEF(visit_file) = *visit_record & eoi;
+
+TEST(Visit, ForEachSubtree) {
+    std::string text;
+    for (size_t i = 0; i < 1000; ++i) text += std::to_string(i) + "," + std::to_string(i) + "\n";
+    StringInput in(text);
+    auto ret = parse(visit_file, in);
+    ASSERT_TRUE(ret);
+
+    std::vector<size_t> sums(1000);
+    size_t count = for_each_subtree(
+        *ret,
+        visit_record.tag,
+        [&](const Token& record, size_t index) {
+            for (const Token& num: record.children)
+                sums[index] += std::stoul(std::string(num.view()));
+        },
+        4);
+    ASSERT_EQ(count, 1000);
+    for (size_t i = 0; i < 1000; ++i) ASSERT_EQ(sums[i], 2 * i);
+
+    // Matches nested in a match are part of it.
+    std::atomic<size_t> tokens = 0;
+    ASSERT_EQ(for_each_subtree(*ret, visit_file.tag, [&](const Token& file) {
+                  for ([[maybe_unused]] const Token& token: preorder(file)) tokens += 1;
+              }),
+              1);
+    ASSERT_EQ(tokens, 1 + 1000 * 3);
+
+    ASSERT_EQ(for_each_subtree(*ret, visit_sum.tag, [](const Token&) { FAIL(); }), 0);
+}
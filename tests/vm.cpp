@@ -0,0 +1,107 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "qcpc/qcpc.hpp"
+#include "qcpc/vm/vm.hpp"
+
+using namespace qcpc;
+
+constexpr const char calc_source[] = R"(
+    # Same as examples/calculator.cpp
+    expr       <- sep sum sep !.
+    sep        <~ [ \t\r\n]*
+    value      <- [0-9]+ / '(' sep sum sep ')'
+    product_op <- [*/]
+    product    <- value (sep product_op sep value)*
+    sum_op     <- [+\-]
+    sum        <- product (sep sum_op sep product)*
+)";
+
+TEST(VM, Bootstrap) {
+    StringInput in(calc_source);
+    auto ret = parse(peg_grammar, in);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret->children.size(), 7);
+    ASSERT_EQ(ret->children[1].children[0].view(), "sep");
+    ASSERT_EQ(ret->children[1].children[1].view(), "<~");
+}
+
+TEST(VM, Parse) {
+    std::string error;
+    auto prog = vm::compile(calc_source, &error);
+    ASSERT_TRUE(prog) << error;
+
+    StringInput in(" 1 + (2*3)\n- 4 ");
+    auto ret = vm::parse(*prog, in);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret->tag(), prog->tag("expr"));
+    ASSERT_EQ(ret->tag(), vm::runtime_tag("expr"));
+    ASSERT_EQ(prog->tag("sep"), NO_RULE);
+
+    const Token& sum = ret->children[0];
+    ASSERT_EQ(sum.tag(), prog->tag("sum"));
+    ASSERT_EQ(sum.view(), "1 + (2*3)\n- 4");
+    ASSERT_EQ(sum.children.size(), 5);
+    ASSERT_EQ(sum.children[1].view(), "+");
+    ASSERT_EQ(sum.children[3].line(), 2);
+    ASSERT_EQ(sum.children[3].column(), 0);
+
+    const Token& paren = sum.children[2].children[0];
+    ASSERT_EQ(paren.view(), "(2*3)");
+    ASSERT_EQ(paren.children[0].tag(), prog->tag("sum"));
+
+    StringInput bad("1 + (2 * 3");
+    ASSERT_FALSE(vm::parse(*prog, bad));
+    ASSERT_EQ(bad.current(), bad.begin());
+}
+
+TEST(VM, Operators) {
+    auto prog = vm::compile(R"(
+        top   <- (word / other)* !.
+        word  <- &[a-z] kw? "\x61"+ [^a\n] ('.' / !.)
+        kw    <- 'if' ![a-z]
+        other <- .
+    )");
+    ASSERT_TRUE(prog);
+
+    StringInput in("aab.if aaz");
+    auto ret = vm::parse(*prog, in);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret->children.size(), 5);
+    ASSERT_EQ(ret->children[0].view(), "aab.");
+    ASSERT_EQ(ret->children[0].tag(), prog->tag("word"));
+    ASSERT_EQ(ret->children[1].view(), "i");
+    ASSERT_EQ(ret->children[1].tag(), prog->tag("other"));
+    ASSERT_EQ(ret->children[4].view(), "aaz");
+}
+
+TEST(VM, Backtrack) {
+    // Tokens of failed alternatives are dropped.
+    auto prog = vm::compile("top <- two '3' / two '4'\ntwo <- '2'");
+    ASSERT_TRUE(prog);
+
+    StringInput in("24");
+    auto ret = vm::parse(*prog, in);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(ret->children.size(), 1);
+    ASSERT_EQ(in.current(), in.end());
+}
+
+TEST(VM, Errors) {
+    auto error_of = [](const char* source) {
+        std::string error;
+        EXPECT_FALSE(vm::compile(source, &error));
+        return error;
+    };
+    ASSERT_EQ(error_of(""), "1:0: empty grammar");
+    ASSERT_EQ(error_of("  # comment\n"), "1:0: empty grammar");
+    // Syntax errors are reported at the farthest failure.
+    ASSERT_TRUE(error_of("a <- 'x' )").starts_with("1:9: expected [ \\t\\r\\n], '#'"));
+    ASSERT_EQ(error_of("a <- 'x'\nb <- [a-"),
+              "2:8: expected \"\\\\x\", '\\\\', any character, '-', peg_range or ']'");
+    ASSERT_EQ(error_of("a <- b"), "1:5: undefined rule 'b'");
+    ASSERT_EQ(error_of("a <- 'x'\na <- 'y'"), "2:0: duplicate rule 'a'");
+    ASSERT_EQ(error_of("a <~ 'x'"), "1:0: the first rule must not be silent");
+    ASSERT_EQ(error_of("a <- ('x'?)*"), "1:5: loop body may accept empty input");
+    ASSERT_EQ(error_of("a <- b 'x'\nb <- 'y'? a"), "1:0: rule 'a' is left recursive");
+}